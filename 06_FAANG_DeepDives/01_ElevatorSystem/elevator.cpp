@@ -5,6 +5,20 @@
 #include <limits>
 #include <memory>
 #include <cmath>
+#include <set>
+#include <deque>
+#include <cstdint>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -33,62 +47,107 @@ struct Request {
 // ELEVATOR CAR
 // ==========================================
 class ElevatorCar {
+public:
+    static constexpr int MAX_FLOORS = 64;   // stop sets / snapshots fit a 64-bit mask
+
 private:
     int id;
+    int num_floors;
     int current_floor;
     Direction direction;
     ElevatorState state;
-    vector<int> destinations; // Floors this elevator needs to visit
+    // LOOK scheduling: stops above the car are served on the up sweep,
+    // stops below on the down sweep, each in floor order.
+    set<int> up_stops;
+    set<int> down_stops;
+    bool logging = true;
+    long long floors_moved = 0;
+    function<void(int, int)> door_listener;   // (car id, floor) — Observer hook
+
+    void open_doors() {
+        if (logging) cout << "  Elevator " << id << ": *** DOORS OPEN at floor " << current_floor << " ***\n";
+        if (door_listener) door_listener(id, current_floor);
+    }
 
 public:
-    ElevatorCar(int id) : id(id), current_floor(0), direction(Direction::IDLE), state(ElevatorState::IDLE) {}
+    ElevatorCar(int id, int num_floors = MAX_FLOORS)
+        : id(id), num_floors(num_floors), current_floor(0), direction(Direction::IDLE), state(ElevatorState::IDLE) {
+        if (num_floors < 1 || num_floors > MAX_FLOORS)
+            throw invalid_argument("ElevatorCar supports 1.." + to_string(MAX_FLOORS) + " floors");
+    }
 
     int get_id() const { return id; }
     int get_current_floor() const { return current_floor; }
     Direction get_direction() const { return direction; }
     bool is_idle() const { return state == ElevatorState::IDLE; }
+    size_t stop_count() const { return up_stops.size() + down_stops.size(); }
+    const set<int>& get_up_stops() const { return up_stops; }
+    const set<int>& get_down_stops() const { return down_stops; }
+    void set_logging(bool on) { logging = on; }
+    void set_door_listener(function<void(int, int)> listener) { door_listener = move(listener); }
+    long long get_floors_moved() const { return floors_moved; }
 
     void add_destination(int floor) {
-        destinations.push_back(floor);
-        if (floor > current_floor) direction = Direction::UP;
-        else if (floor < current_floor) direction = Direction::DOWN;
+        if (floor < 0 || floor >= num_floors) return;   // no such floor
+        // Between steps the car is stopped at current_floor: serve it now
+        // (never queue it on the return sweep, which would run past the shaft)
+        if (floor == current_floor) {
+            open_doors();
+            return;
+        }
+        if (floor > current_floor) up_stops.insert(floor);
+        else down_stops.insert(floor);
+
+        if (direction == Direction::IDLE) {
+            direction = (floor > current_floor) ? Direction::UP : Direction::DOWN;
+        }
         state = ElevatorState::MOVING;
     }
 
     // Simulate one step of movement
     void step() {
-        if (destinations.empty()) {
+        if (up_stops.empty() && down_stops.empty()) {
             state = ElevatorState::IDLE;
             direction = Direction::IDLE;
             return;
         }
 
-        int target = destinations.front();
+        // LOOK: reverse only when nothing is left ahead in this direction
+        if (direction == Direction::UP && up_stops.empty()) direction = Direction::DOWN;
+        else if (direction == Direction::DOWN && down_stops.empty()) direction = Direction::UP;
+
+        // Every stop is in [0, num_floors), so this only guards the invariant
+        int next = current_floor + (direction == Direction::UP ? 1 : -1);
+        if (next < 0 || next >= num_floors) {
+            up_stops.clear();
+            down_stops.clear();
+            state = ElevatorState::IDLE;
+            direction = Direction::IDLE;
+            return;
+        }
 
-        if (current_floor < target) {
+        floors_moved++;
+        if (direction == Direction::UP) {
             current_floor++;
-            direction = Direction::UP;
-            cout << "  Elevator " << id << ": Moving UP to floor " << current_floor << "\n";
-        } else if (current_floor > target) {
+            if (logging) cout << "  Elevator " << id << ": Moving UP to floor " << current_floor << "\n";
+        } else {
             current_floor--;
-            direction = Direction::DOWN;
-            cout << "  Elevator " << id << ": Moving DOWN to floor " << current_floor << "\n";
+            if (logging) cout << "  Elevator " << id << ": Moving DOWN to floor " << current_floor << "\n";
         }
 
-        if (current_floor == target) {
-            cout << "  Elevator " << id << ": *** DOORS OPEN at floor " << current_floor << " ***\n";
-            destinations.erase(destinations.begin());
-            if (destinations.empty()) {
-                state = ElevatorState::IDLE;
-                direction = Direction::IDLE;
-            }
+        set<int>& ahead = (direction == Direction::UP) ? up_stops : down_stops;
+        if (ahead.erase(current_floor)) open_doors();
+
+        if (up_stops.empty() && down_stops.empty()) {
+            state = ElevatorState::IDLE;
+            direction = Direction::IDLE;
         }
     }
 
     void print_status() const {
         cout << "Elevator " << id << ": Floor=" << current_floor 
              << " Dir=" << dir_to_string(direction)
-             << " Stops=" << destinations.size() << "\n";
+             << " Stops=" << stop_count() << "\n";
     }
 };
 
@@ -98,6 +157,17 @@ public:
 class IDispatcher {
 public:
     virtual ElevatorCar* select_elevator(const vector<unique_ptr<ElevatorCar>>& elevators, const Request& request) = 0;
+
+    // Assign a batch of pending hall calls at once. Default: one greedy
+    // select_elevator() per call; smarter strategies can optimize jointly.
+    virtual vector<ElevatorCar*> assign_batch(const vector<unique_ptr<ElevatorCar>>& elevators,
+                                              const vector<Request>& requests) {
+        vector<ElevatorCar*> result;
+        result.reserve(requests.size());
+        for (const auto& r : requests) result.push_back(select_elevator(elevators, r));
+        return result;
+    }
+
     virtual ~IDispatcher() = default;
 };
 
@@ -136,6 +206,215 @@ public:
     }
 };
 
+// Concrete Strategy: minimize estimated time-to-serve.
+// The estimate follows the car's LOOK route through its queued stops, so a
+// car that is close but has a long queue ahead is correctly seen as slow.
+// Batches are assigned jointly with an auction: each car is split into a
+// few "slots" whose cost rises with every extra call it takes, calls bid
+// for the cheapest slot, and contested slots get more expensive until every
+// call settles. This spreads an up-peak burst over the fleet instead of
+// piling it onto whichever car happens to be nearest.
+class CostDispatcher : public IDispatcher {
+    static constexpr double STOP_COST = 3.0;      // door cycle, in floor-travel units
+    static constexpr double MAX_EPSILON = 8.0;    // auction bid increments
+    static constexpr double MIN_EPSILON = 0.125;
+
+public:
+    // Floors travelled + stops made before the car reaches `floor`
+    static double time_to_serve(const ElevatorCar& car, int floor) {
+        int cur = car.get_current_floor();
+        const set<int>& up = car.get_up_stops();
+        const set<int>& down = car.get_down_stops();
+        Direction dir = car.get_direction();
+
+        if (car.is_idle() || (up.empty() && down.empty())) return abs(cur - floor);
+
+        // Stops strictly between a and b (exclusive) in the given set
+        auto between = [](const set<int>& s, int lo, int hi) {
+            return static_cast<double>(distance(s.upper_bound(lo), s.lower_bound(hi)));
+        };
+
+        if (dir == Direction::UP) {
+            if (floor >= cur) return (floor - cur) + STOP_COST * between(up, cur, floor);
+            int top = up.empty() ? cur : *up.rbegin();
+            return (top - cur) + (top - floor)
+                 + STOP_COST * (up.size() + between(down, floor, top + 1));
+        } else {
+            if (floor <= cur) return (cur - floor) + STOP_COST * between(down, floor, cur);
+            int bottom = down.empty() ? cur : *down.begin();
+            return (cur - bottom) + (floor - bottom)
+                 + STOP_COST * (down.size() + between(up, bottom - 1, floor));
+        }
+    }
+
+    ElevatorCar* select_elevator(const vector<unique_ptr<ElevatorCar>>& elevators, const Request& request) override {
+        ElevatorCar* best = nullptr;
+        double best_cost = numeric_limits<double>::max();
+        for (const auto& e : elevators) {
+            double cost = time_to_serve(*e, request.floor);
+            if (cost < best_cost) { best_cost = cost; best = e.get(); }
+        }
+        return best;
+    }
+
+    vector<ElevatorCar*> assign_batch(const vector<unique_ptr<ElevatorCar>>& elevators,
+                                      const vector<Request>& requests) override {
+        int n = static_cast<int>(requests.size());
+        int cars = static_cast<int>(elevators.size());
+        vector<ElevatorCar*> result(n, nullptr);
+        if (n == 0 || cars == 0) return result;
+
+        // Enough slots that the fleet can absorb the whole batch, plus one spare
+        int slots = (n + cars - 1) / cars + 1;
+
+        vector<double> eta(static_cast<size_t>(n) * cars);
+        for (int i = 0; i < n; ++i)
+            for (int c = 0; c < cars; ++c)
+                eta[i * cars + c] = time_to_serve(*elevators[c], requests[i].floor);
+
+        // Taking the k-th slot on a car adds k extra stops in front of the
+        // call, so slot cost = eta + STOP_COST * k + price. The cheapest slot of
+        // a car is the same for every bidder, which lets a bid scan cars
+        // rather than cars x slots.
+        vector<double> price(static_cast<size_t>(cars) * slots, 0.0);
+        vector<double> car_best(cars), car_second(cars);
+        vector<int> car_best_slot(cars);
+        auto refresh_car = [&](int c) {
+            car_best[c] = car_second[c] = numeric_limits<double>::max();
+            for (int k = 0; k < slots; ++k) {
+                double v = STOP_COST * k + price[c * slots + k];
+                if (v < car_best[c]) { car_second[c] = car_best[c]; car_best[c] = v; car_best_slot[c] = k; }
+                else if (v < car_second[c]) car_second[c] = v;
+            }
+        };
+
+        // Epsilon scaling: coarse rounds settle prices quickly, fine rounds
+        // refine them. Without it, identical lobby calls fight over the same
+        // slots in tiny increments for thousands of rounds.
+        vector<int> owner(price.size()), assigned(n);
+        vector<int> unassigned;
+        for (double eps = MAX_EPSILON; ; eps = max(eps / 4, MIN_EPSILON)) {
+            fill(owner.begin(), owner.end(), -1);
+            fill(assigned.begin(), assigned.end(), -1);
+            for (int c = 0; c < cars; ++c) refresh_car(c);
+            unassigned.resize(n);
+            for (int i = 0; i < n; ++i) unassigned[i] = n - 1 - i;
+
+            while (!unassigned.empty()) {
+                int i = unassigned.back();
+                unassigned.pop_back();
+
+                const double* row = &eta[static_cast<size_t>(i) * cars];
+                int best_car = 0;
+                double best_cost = row[0] + car_best[0], second_cost = numeric_limits<double>::max();
+                for (int c = 1; c < cars; ++c) {
+                    double v = row[c] + car_best[c];
+                    if (v < best_cost) { second_cost = best_cost; best_cost = v; best_car = c; }
+                    else if (v < second_cost) second_cost = v;
+                }
+                second_cost = min(second_cost, row[best_car] + car_second[best_car]);
+
+                int obj = best_car * slots + car_best_slot[best_car];
+                price[obj] += (second_cost - best_cost) + eps;
+                refresh_car(best_car);
+                if (owner[obj] >= 0) {
+                    assigned[owner[obj]] = -1;
+                    unassigned.push_back(owner[obj]);
+                }
+                owner[obj] = i;
+                assigned[i] = obj;
+            }
+            if (eps == MIN_EPSILON) break;
+        }
+
+        for (int i = 0; i < n; ++i) result[i] = elevators[assigned[i] / slots].get();
+        return result;
+    }
+};
+
+// ==========================================
+// IDLE POSITIONING STRATEGY
+// ==========================================
+// A car that runs out of stops goes IDLE wherever it happens to be. If the
+// next call usually comes from the lobby at 9 AM, waiting on floor 23 costs
+// every morning passenger the trip down. An idle policy decides where idle
+// cars should wait instead.
+class IIdlePolicy {
+public:
+    // Called on every hall call — must stay O(1), it is on the dispatch path
+    virtual void observe_call(int floor, long long now) = 0;
+    // Called periodically from the simulation loop, off the dispatch path
+    virtual void refresh(long long now) = 0;
+    // Parking floor for each newly idle car, given floors already covered
+    virtual vector<int> park(const vector<int>& idle_floors, const vector<int>& covered_floors,
+                             long long now) = 0;
+    virtual ~IIdlePolicy() = default;
+};
+
+// Learns where calls come from at each time of day with an exponentially
+// decayed histogram per (time slot, floor), then spreads idle cars to
+// minimize the expected distance to the next call.
+class PredictiveParking : public IIdlePolicy {
+    int floors;
+    int slots;                        // time-of-day buckets
+    long long steps_per_day;
+    double decay;                     // weight kept per new observation in a slot
+    vector<vector<double>> histogram; // [slot][floor]
+    vector<pair<int, long long>> pending;   // raw calls not yet folded in
+
+    int slot_of(long long now) const {
+        return static_cast<int>((now % steps_per_day) * slots / steps_per_day);
+    }
+
+public:
+    PredictiveParking(int num_floors, long long day_length, int time_slots = 24, double decay_factor = 0.98)
+        : floors(num_floors), slots(time_slots), steps_per_day(day_length), decay(decay_factor),
+          histogram(time_slots, vector<double>(num_floors, 0.0)) {}
+
+    void observe_call(int floor, long long now) override {
+        pending.push_back({floor, now});
+    }
+
+    void refresh(long long) override {
+        for (auto [floor, when] : pending) {
+            if (floor < 0 || floor >= floors) continue;
+            auto& h = histogram[slot_of(when)];
+            for (double& w : h) w *= decay;   // older calls fade out
+            h[floor] += 1.0;
+        }
+        pending.clear();
+    }
+
+    vector<int> park(const vector<int>& idle_floors, const vector<int>& covered_floors,
+                     long long now) override {
+        const auto& h = histogram[slot_of(now)];
+        double total = 0;
+        for (double w : h) total += w;
+        if (total == 0) return idle_floors;   // nothing learned yet: stay put
+
+        // Distance from each floor to the nearest car already covering it
+        vector<int> nearest(floors, floors);
+        for (int c : covered_floors)
+            for (int f = 0; f < floors; ++f) nearest[f] = min(nearest[f], abs(f - c));
+
+        // Greedy placement: each car takes the floor that most reduces the
+        // expected distance to the next call
+        vector<int> targets;
+        for (size_t i = 0; i < idle_floors.size(); ++i) {
+            int best_floor = idle_floors[i];
+            double best_cost = numeric_limits<double>::max();
+            for (int cand = 0; cand < floors; ++cand) {
+                double cost = 0;
+                for (int f = 0; f < floors; ++f) cost += h[f] * min(nearest[f], abs(f - cand));
+                if (cost < best_cost) { best_cost = cost; best_floor = cand; }
+            }
+            targets.push_back(best_floor);
+            for (int f = 0; f < floors; ++f) nearest[f] = min(nearest[f], abs(f - best_floor));
+        }
+        return targets;
+    }
+};
+
 // ==========================================
 // ELEVATOR SYSTEM (Facade / Controller)
 // ==========================================
@@ -143,33 +422,160 @@ class ElevatorSystem {
 private:
     vector<unique_ptr<ElevatorCar>> elevators;
     unique_ptr<IDispatcher> dispatcher;
+    bool logging = true;
+
+    static constexpr int IDLE_REFRESH_STEPS = 50;
+    unique_ptr<IIdlePolicy> idle_policy;
+    vector<int> parking_target;       // per car, -1 = not parked / parking
+    long long clock = 0;              // simulation steps so far
+
+    // A dispatched car stops covering its parking floor
+    void mark_busy(const ElevatorCar& car) { parking_target[car.get_id() - 1] = -1; }
+
+    // Send cars that just went idle to the policy's parking floors
+    void park_idle_cars(const vector<bool>& was_idle) {
+        vector<int> newly_idle, idle_floors, covered;
+        for (size_t i = 0; i < elevators.size(); ++i) {
+            ElevatorCar& car = *elevators[i];
+            if (parking_target[i] >= 0 && !car.is_idle()) {
+                covered.push_back(parking_target[i]);          // on its way to park
+            } else if (car.is_idle() && (was_idle[i] || car.get_current_floor() == parking_target[i])) {
+                covered.push_back(car.get_current_floor());    // already waiting
+            } else if (car.is_idle()) {
+                newly_idle.push_back(static_cast<int>(i));
+                idle_floors.push_back(car.get_current_floor());
+            } else {
+                parking_target[i] = -1;                        // busy with passengers
+            }
+        }
+        if (newly_idle.empty()) return;
+
+        vector<int> targets = idle_policy->park(idle_floors, covered, clock);
+        for (size_t k = 0; k < newly_idle.size(); ++k) {
+            int i = newly_idle[k];
+            parking_target[i] = targets[k];
+            if (targets[k] != idle_floors[k]) {
+                if (logging) cout << "   Parking Elevator " << elevators[i]->get_id() << " at floor " << targets[k] << "\n";
+                elevators[i]->add_destination(targets[k]);
+            }
+        }
+    }
+
+    // After the demand model changes (new observations, next time-of-day
+    // slot), re-plan every idle car: cars already on a new target stay, the
+    // rest move to the nearest target left over.
+    void repark_idle_cars() {
+        vector<int> idle, idle_floors, covered;
+        for (size_t i = 0; i < elevators.size(); ++i) {
+            ElevatorCar& car = *elevators[i];
+            if (car.is_idle()) {
+                idle.push_back(static_cast<int>(i));
+                idle_floors.push_back(car.get_current_floor());
+            } else if (parking_target[i] >= 0) {
+                covered.push_back(parking_target[i]);          // still on its way to park
+            }
+        }
+        if (idle.empty()) return;
+
+        vector<int> targets = idle_policy->park(idle_floors, covered, clock);
+        multiset<int> open(targets.begin(), targets.end());
+        vector<bool> placed(idle.size(), false);
+        for (size_t k = 0; k < idle.size(); ++k) {
+            auto hit = open.find(idle_floors[k]);
+            if (hit == open.end()) continue;
+            open.erase(hit);
+            placed[k] = true;
+            parking_target[idle[k]] = idle_floors[k];
+        }
+        for (size_t k = 0; k < idle.size() && !open.empty(); ++k) {
+            if (placed[k]) continue;
+            auto best = min_element(open.begin(), open.end(), [&](int a, int b) {
+                return abs(a - idle_floors[k]) < abs(b - idle_floors[k]);
+            });
+            int target = *best;
+            open.erase(best);
+            parking_target[idle[k]] = target;
+            if (logging) cout << "   Re-parking Elevator " << elevators[idle[k]]->get_id() << " at floor " << target << "\n";
+            elevators[idle[k]]->add_destination(target);
+        }
+    }
 
 public:
     ElevatorSystem(int num_elevators, unique_ptr<IDispatcher> disp) : dispatcher(move(disp)) {
         for (int i = 0; i < num_elevators; ++i) {
             elevators.push_back(make_unique<ElevatorCar>(i + 1));
         }
+        parking_target.assign(num_elevators, -1);
+    }
+
+    void set_idle_policy(unique_ptr<IIdlePolicy> policy) { idle_policy = move(policy); }
+
+    // Turn off console output for batch/what-if runs
+    void set_logging(bool on) {
+        logging = on;
+        for (auto& e : elevators) e->set_logging(on);
     }
 
-    void handle_request(const Request& req) {
-        cout << "\n>> External Request: Floor " << req.floor << " " << dir_to_string(req.direction) << "\n";
+    // Returns the id of the dispatched car (0 if none)
+    int handle_request(const Request& req) {
+        if (logging) cout << "\n>> External Request: Floor " << req.floor << " " << dir_to_string(req.direction) << "\n";
+        if (idle_policy) idle_policy->observe_call(req.floor, clock);
         ElevatorCar* selected = dispatcher->select_elevator(elevators, req);
-        if (selected) {
-            cout << "   Dispatched Elevator " << selected->get_id() << " to floor " << req.floor << "\n";
-            selected->add_destination(req.floor);
+        if (!selected) return 0;
+        if (logging) cout << "   Dispatched Elevator " << selected->get_id() << " to floor " << req.floor << "\n";
+        mark_busy(*selected);
+        selected->add_destination(req.floor);
+        return selected->get_id();
+    }
+
+    // Dispatch several pending hall calls together (e.g. every 500 ms).
+    // Returns the chosen car id per request (0 if none).
+    vector<int> handle_requests(const vector<Request>& reqs) {
+        if (idle_policy)
+            for (const auto& r : reqs) idle_policy->observe_call(r.floor, clock);
+        vector<ElevatorCar*> chosen = dispatcher->assign_batch(elevators, reqs);
+        vector<int> ids(reqs.size(), 0);
+        for (size_t i = 0; i < reqs.size(); ++i) {
+            if (!chosen[i]) continue;
+            if (logging) cout << "   Batch: floor " << reqs[i].floor << " -> Elevator " << chosen[i]->get_id() << "\n";
+            ids[i] = chosen[i]->get_id();
+            mark_busy(*chosen[i]);
+            chosen[i]->add_destination(reqs[i].floor);
         }
+        return ids;
+    }
+
+    void set_door_listener(const function<void(int, int)>& listener) {
+        for (auto& e : elevators) e->set_door_listener(listener);
+    }
+
+    long long total_floors_moved() const {
+        long long total = 0;
+        for (const auto& e : elevators) total += e->get_floors_moved();
+        return total;
     }
 
     void press_floor_button(int elevator_id, int destination_floor) {
-        cout << "\n>> Internal Button: Elevator " << elevator_id << " → Floor " << destination_floor << "\n";
+        if (logging) cout << "\n>> Internal Button: Elevator " << elevator_id << " → Floor " << destination_floor << "\n";
+        mark_busy(*elevators[elevator_id - 1]);
         elevators[elevator_id - 1]->add_destination(destination_floor);
     }
 
     void simulate_steps(int steps) {
-        cout << "\n--- Simulating " << steps << " time steps ---\n";
+        if (logging) cout << "\n--- Simulating " << steps << " time steps ---\n";
+        vector<bool> was_idle(elevators.size());
         for (int s = 0; s < steps; ++s) {
-            for (auto& e : elevators) {
-                e->step();
+            for (size_t i = 0; i < elevators.size(); ++i) {
+                was_idle[i] = elevators[i]->is_idle();
+                elevators[i]->step();
+            }
+            ++clock;
+            if (idle_policy) {
+                if (clock % IDLE_REFRESH_STEPS == 0) {
+                    idle_policy->refresh(clock);
+                    repark_idle_cars();
+                }
+                park_idle_cars(was_idle);
             }
         }
     }
@@ -182,10 +588,869 @@ public:
     }
 };
 
+// ==========================================
+// CONCURRENT CONTROLLER (One Actor per Car)
+// ==========================================
+// ElevatorSystem mutates cars directly, so hall calls and car movement must
+// run on one thread (or behind one global lock). Here every car is an
+// actor: only its own thread ever touches the ElevatorCar. Other threads
+// talk to it through a lock-free mailbox and observe it through an atomic
+// snapshot, so hall calls are dispatched while cars are moving.
+
+// Multi-producer / single-consumer queue (Vyukov): producers do one atomic
+// exchange, the consumer never blocks them.
+template <typename T>
+class MpscMailbox {
+    struct Node {
+        atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    atomic<Node*> head;   // producers append here
+    Node* tail;           // consumer reads here (tail is a consumed dummy)
+
+public:
+    MpscMailbox() : head(new Node()), tail(head.load()) {}
+    ~MpscMailbox() {
+        T ignored;
+        while (pop(ignored)) {}
+        delete tail;
+    }
+    MpscMailbox(const MpscMailbox&) = delete;
+    MpscMailbox& operator=(const MpscMailbox&) = delete;
+
+    void push(T value) {
+        Node* node = new Node();
+        node->value = move(value);
+        Node* prev = head.exchange(node, memory_order_acq_rel);
+        prev->next.store(node, memory_order_release);
+    }
+
+    // Consumer thread only
+    bool pop(T& out) {
+        Node* next = tail->next.load(memory_order_acquire);
+        if (!next) return false;
+        out = move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+};
+
+// Position/direction/load packed into one word so readers never see a torn mix
+struct CarSnapshot {
+    int floor = 0;
+    Direction direction = Direction::IDLE;
+    int stops = 0;
+
+    uint64_t pack() const {
+        return (uint64_t(uint32_t(floor)) << 32) | (uint64_t(direction) << 24) | uint32_t(stops & 0xFFFFFF);
+    }
+    static CarSnapshot unpack(uint64_t w) {
+        return {int(int32_t(w >> 32)), Direction((w >> 24) & 0xFF), int(w & 0xFFFFFF)};
+    }
+};
+
+class ElevatorActor {
+    ElevatorCar car;
+    MpscMailbox<int> mailbox;          // destination floors
+    atomic<uint64_t> snapshot{CarSnapshot{}.pack()};
+    atomic<int> in_flight{0};          // sent but not yet applied
+    atomic<bool> running{true};
+    chrono::microseconds tick;
+    thread worker;
+
+    void publish() {
+        snapshot.store(CarSnapshot{car.get_current_floor(), car.get_direction(),
+                                   static_cast<int>(car.stop_count())}.pack(),
+                       memory_order_release);
+    }
+
+    void run() {
+        car.set_logging(false);        // console output from many threads interleaves
+        int floor;
+        while (running.load(memory_order_acquire)) {
+            int applied = 0;
+            while (mailbox.pop(floor)) {
+                car.add_destination(floor);
+                ++applied;
+            }
+            if (applied) {
+                // Publish the new stops before un-counting them, so readers
+                // never see a moment where a request is in neither number.
+                publish();
+                in_flight.fetch_sub(applied, memory_order_release);
+            }
+            car.step();                // one floor per tick
+            publish();
+            this_thread::sleep_for(tick);
+        }
+    }
+
+public:
+    ElevatorActor(int id, chrono::microseconds tick_length)
+        : car(id), tick(tick_length), worker([this] { run(); }) {}
+
+    ~ElevatorActor() {
+        running.store(false, memory_order_release);
+        worker.join();
+    }
+
+    int id() const { return car.get_id(); }
+
+    // Safe from any thread
+    void send(int floor) {
+        in_flight.fetch_add(1, memory_order_relaxed);
+        mailbox.push(floor);
+    }
+
+    CarSnapshot read() const {
+        // in_flight first: if it already excludes a request, the acquire
+        // synchronises with run()'s release, so the snapshot loaded next
+        // includes that request's stop. The other order can miss it in both.
+        int pending = in_flight.load(memory_order_acquire);
+        CarSnapshot snap = CarSnapshot::unpack(snapshot.load(memory_order_acquire));
+        snap.stops += pending;
+        return snap;
+    }
+
+    bool quiescent() const {
+        CarSnapshot snap = read();
+        return snap.stops == 0 && snap.direction == Direction::IDLE;
+    }
+};
+
+class ConcurrentElevatorSystem {
+    vector<unique_ptr<ElevatorActor>> actors;
+    atomic<long long> dispatched{0};
+
+public:
+    ConcurrentElevatorSystem(int num_elevators, chrono::microseconds tick) {
+        for (int i = 0; i < num_elevators; ++i)
+            actors.push_back(make_unique<ElevatorActor>(i + 1, tick));
+    }
+
+    // Callable concurrently from any number of floor-panel threads.
+    // Returns the chosen car's id (0 if there are no cars).
+    // Same rule as NearestDispatcher, applied to snapshots, with queued stops
+    // as a tie-breaking load penalty.
+    int handle_request(const Request& req) {
+        ElevatorActor* best = nullptr;
+        int best_score = numeric_limits<int>::max();
+        for (const auto& a : actors) {
+            CarSnapshot snap = a->read();
+            bool suitable = snap.direction == Direction::IDLE ||
+                (snap.direction == Direction::UP && req.floor >= snap.floor) ||
+                (snap.direction == Direction::DOWN && req.floor <= snap.floor);
+            int score = abs(snap.floor - req.floor) + 2 * snap.stops + (suitable ? 0 : 1000);
+            if (score < best_score) { best_score = score; best = a.get(); }
+        }
+        if (!best) return 0;   // no cars
+        best->send(req.floor);
+        dispatched.fetch_add(1, memory_order_relaxed);
+        return best->id();
+    }
+
+    void press_floor_button(int elevator_id, int destination_floor) {
+        actors[elevator_id - 1]->send(destination_floor);
+    }
+
+    void wait_until_idle() const {
+        auto all_idle = [this] {
+            for (const auto& a : actors) if (!a->quiescent()) return false;
+            return true;
+        };
+        while (!all_idle()) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    long long total_dispatched() const { return dispatched.load(); }
+    size_t size() const { return actors.size(); }
+};
+
+void demo_concurrent_controller() {
+    const int cars = 8, panels = 4, calls_per_panel = 100, floors = 30;
+    ConcurrentElevatorSystem system(cars, chrono::microseconds(200));
+
+    vector<vector<int>> per_car(panels, vector<int>(cars, 0));
+    auto start = chrono::steady_clock::now();
+    vector<thread> panel_threads;
+    for (int p = 0; p < panels; ++p) {
+        panel_threads.emplace_back([&, p] {
+            mt19937 rng(100 + p);
+            uniform_int_distribution<int> any_floor(0, floors - 1);
+            for (int i = 0; i < calls_per_panel; ++i) {
+                int car = system.handle_request(Request(any_floor(rng), Direction::UP));
+                if (car == 0) continue;
+                per_car[p][car - 1]++;
+                system.press_floor_button(car, any_floor(rng));   // rider's destination
+                this_thread::sleep_for(chrono::microseconds(300));
+            }
+        });
+    }
+    for (auto& t : panel_threads) t.join();
+    system.wait_until_idle();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << panels << " panel threads dispatched " << system.total_dispatched()
+         << " hall calls to " << cars << " moving cars (no global lock)\n";
+    cout << "  Calls per car:";
+    for (int c = 0; c < cars; ++c) {
+        int total = 0;
+        for (int p = 0; p < panels; ++p) total += per_car[p][c];
+        cout << " " << total;
+    }
+    cout << "\n  All cars idle after " << fixed << setprecision(1) << ms << " ms\n";
+}
+
+// ==========================================
+// DISCRETE-EVENT CAMPUS SIMULATOR
+// ==========================================
+// simulate_steps() visits every car every tick, even cars that are idle or
+// halfway through a 20-floor run. For what-if studies over whole campuses
+// we instead keep a time-ordered event queue and jump straight from one
+// arrival / door event to the next. Car state lives in flat arrays
+// (struct-of-arrays) and stop sets are 64-bit floor masks, so the hot loop
+// touches a few cache lines per event and never prints.
+// FIFO = serve stops in request order (the original ElevatorCar behaviour)
+// LOOK = sweep in one direction while stops remain ahead, then reverse
+enum class StopPolicy { FIFO, LOOK };
+
+struct CampusConfig {
+    int buildings = 200;
+    int cars_per_building = 16;
+    int floors = 40;                        // <= 64: stops are a uint64_t mask
+    int sim_seconds = 3600;
+    double calls_per_building_per_min = 6.0;
+    double lobby_share = 0.5;               // fraction of calls starting at floor 0
+    int floor_travel_s = 2;
+    int door_dwell_s = 5;
+    StopPolicy stop_policy = StopPolicy::LOOK;
+    unsigned seed = 42;
+};
+
+struct CampusStats {
+    long long calls = 0;
+    long long served = 0;                   // passengers delivered
+    long long events = 0;
+    long long floors_moved = 0;
+    double avg_wait_s = 0;
+    double p95_wait_s = 0;
+    double avg_trip_s = 0;
+    double throughput_per_hour = 0;         // delivered / time of last delivery
+    double wall_ms = 0;
+};
+
+class CampusSimulator {
+    enum class CarState : uint8_t { IDLE, MOVING, DWELL };
+    enum class EventType : uint8_t { HALL_CALL, CAR_ARRIVE, CAR_DEPART };
+
+    struct Event {
+        int64_t time;
+        EventType type;
+        int subject;                        // passenger id or car index
+        uint32_t version;                   // stale car events are skipped
+        bool operator>(const Event& o) const { return time > o.time; }
+    };
+
+    CampusConfig cfg;
+
+    // Passengers (struct-of-arrays)
+    vector<int> p_building, p_origin, p_dest;
+    vector<int64_t> p_call_time, p_board_time;
+    vector<double> waits;
+    double trip_sum = 0;
+    int64_t last_delivery = 0;
+
+    // Cars (struct-of-arrays), car c belongs to building c / cars_per_building
+    vector<int> car_floor;                  // floor at last stop / departure
+    vector<int> car_target;
+    vector<int8_t> car_dir;                 // +1 up, -1 down, 0 none
+    vector<CarState> car_state;
+    vector<int64_t> car_depart_time;
+    vector<uint64_t> car_stops;             // bit f set = must stop at floor f
+    vector<deque<int>> car_fifo;            // request order (FIFO policy only)
+    vector<uint32_t> car_version;
+    vector<vector<int>> car_waiting;        // assigned, not yet boarded
+    vector<vector<int>> car_riders;
+
+    priority_queue<Event, vector<Event>, greater<Event>> events;
+    CampusStats stats;
+
+    static uint64_t bit(int f) { return 1ULL << f; }
+
+    void schedule_car(int c, int64_t t, EventType type) {
+        events.push({t, type, c, ++car_version[c]});
+    }
+
+    // Floor the car is at (or just passed) at time t
+    int position_at(int c, int64_t t) const {
+        if (car_state[c] != CarState::MOVING) return car_floor[c];
+        int64_t passed = (t - car_depart_time[c]) / cfg.floor_travel_s;
+        int dist = abs(car_target[c] - car_floor[c]);
+        return car_floor[c] + car_dir[c] * static_cast<int>(min<int64_t>(passed, dist));
+    }
+
+    void add_stop(int c, int floor) {
+        if (car_stops[c] & bit(floor)) return;
+        car_stops[c] |= bit(floor);
+        if (cfg.stop_policy == StopPolicy::FIFO) car_fifo[c].push_back(floor);
+    }
+
+    bool pick_next_stop(int c) {
+        int f = car_floor[c];
+        if (cfg.stop_policy == StopPolicy::FIFO) {
+            if (car_fifo[c].empty()) return false;
+            car_target[c] = car_fifo[c].front();
+            car_fifo[c].pop_front();
+            car_dir[c] = car_target[c] >= f ? 1 : -1;
+            return true;
+        }
+
+        // LOOK: keep sweeping while there are stops ahead, otherwise reverse
+        uint64_t m = car_stops[c] & ~bit(f);
+        if (!m) return false;
+        uint64_t above = m & ~((bit(f) << 1) - 1);
+        uint64_t below = m & (bit(f) - 1);
+        bool go_up = car_dir[c] >= 0 ? (above != 0) : (below == 0);
+        if (go_up) {
+            car_target[c] = __builtin_ctzll(above);
+            car_dir[c] = 1;
+        } else {
+            car_target[c] = 63 - __builtin_clzll(below);
+            car_dir[c] = -1;
+        }
+        return true;
+    }
+
+    void board_at(int c, int floor, int64_t t) {
+        auto& waiting = car_waiting[c];
+        for (size_t i = 0; i < waiting.size();) {
+            int p = waiting[i];
+            if (p_origin[p] == floor) {
+                p_board_time[p] = t;
+                waits.push_back(double(t - p_call_time[p]));
+                car_riders[c].push_back(p);
+                add_stop(c, p_dest[p]);
+                waiting[i] = waiting.back();
+                waiting.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    void alight_at(int c, int floor, int64_t t) {
+        auto& riders = car_riders[c];
+        for (size_t i = 0; i < riders.size();) {
+            int p = riders[i];
+            if (p_dest[p] == floor) {
+                trip_sum += double(t - p_call_time[p]);
+                last_delivery = max(last_delivery, t);
+                stats.served++;
+                riders[i] = riders.back();
+                riders.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Estimated seconds until car c could reach `floor`
+    int64_t eta(int c, int floor, int64_t t) const {
+        int pos = position_at(c, t);
+        int stops = __builtin_popcountll(car_stops[c]);
+        if (car_state[c] == CarState::IDLE) return int64_t(abs(pos - floor)) * cfg.floor_travel_s;
+        bool ahead = car_dir[c] * (floor - pos) >= 0;
+        int dist = ahead ? abs(floor - pos)
+                         : abs(car_target[c] - pos) + abs(car_target[c] - floor);
+        return int64_t(dist) * cfg.floor_travel_s + int64_t(stops) * cfg.door_dwell_s;
+    }
+
+    void on_hall_call(int p, int64_t t) {
+        int b = p_building[p], first = b * cfg.cars_per_building;
+        int best = first;
+        int64_t best_eta = eta(first, p_origin[p], t);
+        for (int c = first + 1; c < first + cfg.cars_per_building; ++c) {
+            int64_t e = eta(c, p_origin[p], t);
+            if (e < best_eta) { best_eta = e; best = c; }
+        }
+        assign(best, p, t);
+    }
+
+    void assign(int c, int p, int64_t t) {
+        int origin = p_origin[p];
+        car_waiting[c].push_back(p);
+
+        if (car_state[c] != CarState::MOVING && car_floor[c] == origin) {
+            board_at(c, origin, t);                 // doors open right here
+            if (car_state[c] == CarState::IDLE) {
+                car_state[c] = CarState::DWELL;
+                schedule_car(c, t + cfg.door_dwell_s, EventType::CAR_DEPART);
+            }
+            return;
+        }
+
+        add_stop(c, origin);
+        if (car_state[c] == CarState::IDLE) {
+            car_dir[c] = 0;
+            schedule_car(c, t, EventType::CAR_DEPART);
+        } else if (car_state[c] == CarState::MOVING && cfg.stop_policy == StopPolicy::LOOK) {
+            // Retarget if the new stop lies ahead of us but before our target
+            int next_reachable = position_at(c, t) + car_dir[c];
+            int dir = car_dir[c];
+            if (dir * (origin - next_reachable) >= 0 && dir * (car_target[c] - origin) > 0) {
+                car_target[c] = origin;
+                schedule_car(c, car_depart_time[c] + int64_t(abs(origin - car_floor[c])) * cfg.floor_travel_s,
+                             EventType::CAR_ARRIVE);
+            }
+        }
+        // DWELL: the pending CAR_DEPART will pick the stop up
+    }
+
+    void on_arrive(int c, int64_t t) {
+        stats.floors_moved += abs(car_target[c] - car_floor[c]);
+        int f = car_target[c];
+        car_floor[c] = f;
+        car_stops[c] &= ~bit(f);
+        car_state[c] = CarState::DWELL;
+        alight_at(c, f, t);
+        board_at(c, f, t);
+        schedule_car(c, t + cfg.door_dwell_s, EventType::CAR_DEPART);
+    }
+
+    void on_depart(int c, int64_t t) {
+        if (!pick_next_stop(c)) {
+            car_state[c] = CarState::IDLE;
+            car_dir[c] = 0;
+            return;
+        }
+        car_state[c] = CarState::MOVING;
+        car_depart_time[c] = t;
+        schedule_car(c, t + int64_t(abs(car_target[c] - car_floor[c])) * cfg.floor_travel_s,
+                     EventType::CAR_ARRIVE);
+    }
+
+    void generate_calls() {
+        mt19937 rng(cfg.seed);
+        exponential_distribution<double> gap(cfg.calls_per_building_per_min / 60.0);
+        uniform_int_distribution<int> any_floor(0, cfg.floors - 1);
+        bernoulli_distribution from_lobby(cfg.lobby_share);
+
+        for (int b = 0; b < cfg.buildings; ++b) {
+            for (double t = gap(rng); t < cfg.sim_seconds; t += gap(rng)) {
+                int origin = from_lobby(rng) ? 0 : any_floor(rng);
+                int dest = any_floor(rng);
+                while (dest == origin) dest = any_floor(rng);
+
+                int p = static_cast<int>(p_origin.size());
+                p_building.push_back(b);
+                p_origin.push_back(origin);
+                p_dest.push_back(dest);
+                p_call_time.push_back(static_cast<int64_t>(t));
+                p_board_time.push_back(-1);
+                events.push({static_cast<int64_t>(t), EventType::HALL_CALL, p, 0});
+            }
+        }
+        stats.calls = static_cast<long long>(p_origin.size());
+    }
+
+public:
+    explicit CampusSimulator(const CampusConfig& config) : cfg(config) {
+        if (cfg.floors < 1 || cfg.floors > 64)
+            throw invalid_argument("CampusSimulator: floors must be in 1..64 (uint64_t stop masks)");
+        int cars = cfg.buildings * cfg.cars_per_building;
+        car_floor.assign(cars, 0);
+        car_target.assign(cars, 0);
+        car_dir.assign(cars, 0);
+        car_state.assign(cars, CarState::IDLE);
+        car_depart_time.assign(cars, 0);
+        car_stops.assign(cars, 0);
+        car_fifo.resize(cars);
+        car_version.assign(cars, 0);
+        car_waiting.resize(cars);
+        car_riders.resize(cars);
+    }
+
+    // Runs until every generated passenger has been delivered
+    CampusStats run() {
+        auto start = chrono::steady_clock::now();
+        generate_calls();
+
+        while (!events.empty()) {
+            Event ev = events.top();
+            events.pop();
+            stats.events++;
+            if (ev.type == EventType::HALL_CALL) {
+                on_hall_call(ev.subject, ev.time);
+            } else if (ev.version == car_version[ev.subject]) {
+                if (ev.type == EventType::CAR_ARRIVE) on_arrive(ev.subject, ev.time);
+                else on_depart(ev.subject, ev.time);
+            }
+        }
+
+        if (!waits.empty()) {
+            double sum = 0;
+            for (double w : waits) sum += w;
+            stats.avg_wait_s = sum / waits.size();
+            size_t k = waits.size() * 95 / 100;
+            nth_element(waits.begin(), waits.begin() + k, waits.end());
+            stats.p95_wait_s = waits[k];
+        }
+        if (stats.served) stats.avg_trip_s = trip_sum / stats.served;
+        if (last_delivery > 0) stats.throughput_per_hour = stats.served * 3600.0 / last_delivery;
+        stats.wall_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+};
+
+void print_campus_stats(const CampusConfig& cfg, const CampusStats& s) {
+    long long car_ticks = 1LL * cfg.buildings * cfg.cars_per_building * cfg.sim_seconds;
+    cout << fixed << setprecision(1);
+    cout << (cfg.stop_policy == StopPolicy::LOOK ? "[LOOK] " : "[FIFO] ");
+    cout << "Campus: " << cfg.buildings << " buildings x " << cfg.cars_per_building << " cars x "
+         << cfg.floors << " floors, " << cfg.sim_seconds << " s simulated\n";
+    cout << "  Passengers: " << s.served << "/" << s.calls << " delivered\n";
+    cout << "  Wait: avg " << s.avg_wait_s << " s, p95 " << s.p95_wait_s
+         << " s | Trip: avg " << s.avg_trip_s << " s | Floors moved: " << s.floors_moved << "\n";
+    cout << "  Throughput: " << s.throughput_per_hour << " passengers/hour\n";
+    cout << "  Events processed: " << s.events << " (a per-tick loop would do "
+         << car_ticks << " car-steps)\n";
+    cout << "  Wall time: " << s.wall_ms << " ms\n";
+}
+
+// ==========================================
+// DISPATCHER BENCHMARK (64 cars x 200 calls)
+// ==========================================
+void benchmark_dispatchers() {
+    const int cars = 64, calls = 200, floors = 60, rounds = 50;
+    mt19937 rng(7);
+    uniform_int_distribution<int> any_floor(0, floors - 1);
+
+    // Fleet in mid-service: random positions with a few queued stops each
+    vector<unique_ptr<ElevatorCar>> fleet;
+    for (int c = 0; c < cars; ++c) {
+        auto car = make_unique<ElevatorCar>(c + 1);
+        car->set_logging(false);
+        car->add_destination(any_floor(rng));
+        for (int s = any_floor(rng) % 10; s > 0; --s) car->step();
+        for (int k = 0; k < 3; ++k) car->add_destination(any_floor(rng));
+        fleet.push_back(move(car));
+    }
+
+    // Up-peak burst: most calls from the lobby
+    vector<Request> burst;
+    for (int i = 0; i < calls; ++i)
+        burst.emplace_back(i % 3 ? 0 : any_floor(rng), Direction::UP);
+
+    auto evaluate = [&](IDispatcher& d, const char* name) {
+        vector<ElevatorCar*> chosen;
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) chosen = d.assign_batch(fleet, burst);
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / rounds;
+
+        // Score: time-to-serve incl. the calls queued ahead on the same car
+        vector<int> load(cars, 0);
+        double total = 0;
+        for (int i = 0; i < calls; ++i) {
+            int idx = chosen[i]->get_id() - 1;
+            total += CostDispatcher::time_to_serve(*chosen[i], burst[i].floor) + 3.0 * load[idx]++;
+        }
+        cout << fixed << setprecision(1) << "  " << setw(18) << left << name << right
+             << " avg time-to-serve " << setw(6) << total / calls
+             << " | busiest car " << setw(3) << *max_element(load.begin(), load.end()) << " calls"
+             << " | " << setw(7) << us << " us/batch\n";
+    };
+
+    cout << "Batch of " << calls << " hall calls over " << cars << " cars:\n";
+    NearestDispatcher nearest;
+    CostDispatcher cost;
+    evaluate(nearest, "NearestDispatcher");
+    evaluate(cost, "CostDispatcher");
+}
+
+// ==========================================
+// TRACE REPLAY & DISPATCHER BENCHMARK HARNESS
+// ==========================================
+// Replays recorded hall calls through ElevatorSystem once per dispatcher
+// (each on its own thread) and compares passenger-facing metrics.
+// Trace formats:
+//   CSV:    "time,floor,destination" per line (header optional), time in steps
+//   Binary: "ELVT" magic, uint32 count, then count x {int32 time, floor, dest}
+struct TraceCall {
+    int32_t time;
+    int32_t floor;
+    int32_t destination;
+};
+
+// Replay walks calls in time order; recorded files need not be sorted
+void sort_by_time(vector<TraceCall>& trace) {
+    stable_sort(trace.begin(), trace.end(), [](const TraceCall& a, const TraceCall& b) { return a.time < b.time; });
+}
+
+// A call the replay can deliver: no negative times, both floors in the building
+const char* trace_call_error(const TraceCall& c, int num_floors) {
+    if (c.time < 0) return "negative time";
+    if (c.floor < 0 || c.floor >= num_floors) return "origin floor out of range";
+    if (c.destination < 0 || c.destination >= num_floors) return "destination floor out of range";
+    return nullptr;
+}
+
+// Bad rows are dropped, but never silently: one summary line on stderr
+void report_rejected_rows(int rejected, const string& first) {
+    if (rejected > 0)
+        cerr << "Warning: skipped " << rejected << " invalid trace row(s); first: " << first << "\n";
+}
+
+vector<TraceCall> load_trace_csv(istream& in, int num_floors = ElevatorCar::MAX_FLOORS) {
+    vector<TraceCall> trace;
+    string line, first_error;
+    int line_no = 0, rejected = 0;
+    bool seen_content = false;
+    while (getline(in, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#') continue;   // blank lines / comments
+        TraceCall c{};
+        char comma1 = 0, comma2 = 0;
+        istringstream row(line);
+        const char* error = nullptr;
+        if (!(row >> c.time >> comma1 >> c.floor >> comma2 >> c.destination) || comma1 != ',' || comma2 != ',') {
+            bool header = !seen_content && !isdigit(static_cast<unsigned char>(line[0])) && line[0] != '-';
+            seen_content = true;
+            if (header) continue;
+            error = "not \"time,floor,destination\"";
+        } else {
+            error = trace_call_error(c, num_floors);
+        }
+        seen_content = true;
+        if (error) {
+            if (rejected++ == 0) first_error = "line " + to_string(line_no) + ": " + error;
+            continue;
+        }
+        trace.push_back(c);
+    }
+    report_rejected_rows(rejected, first_error);
+    sort_by_time(trace);
+    return trace;
+}
+
+void save_trace_csv(ostream& out, const vector<TraceCall>& trace) {
+    out << "time,floor,destination\n";
+    for (const auto& c : trace) out << c.time << "," << c.floor << "," << c.destination << "\n";
+}
+
+vector<TraceCall> load_trace_binary(istream& in, int num_floors = ElevatorCar::MAX_FLOORS) {
+    char magic[4];
+    uint32_t count = 0;
+    if (!in.read(magic, 4) || string(magic, 4) != "ELVT" ||
+        !in.read(reinterpret_cast<char*>(&count), sizeof(count)))
+        return {};
+    // Never trust the header for the allocation: cap it by the bytes left
+    size_t records = count;
+    streampos body = in.tellg();
+    if (body != streampos(-1) && in.seekg(0, ios::end)) {
+        size_t remaining = static_cast<size_t>(in.tellg() - body);
+        records = min(records, remaining / sizeof(TraceCall));
+        in.seekg(body);
+    }
+    vector<TraceCall> trace(records);
+    in.read(reinterpret_cast<char*>(trace.data()), streamsize(records * sizeof(TraceCall)));
+    trace.resize(static_cast<size_t>(in.gcount()) / sizeof(TraceCall));
+    int rejected = 0;
+    string first_error;
+    size_t kept = 0;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        if (const char* error = trace_call_error(trace[i], num_floors)) {
+            if (rejected++ == 0) first_error = "record " + to_string(i) + ": " + error;
+        } else {
+            trace[kept++] = trace[i];
+        }
+    }
+    trace.resize(kept);
+    report_rejected_rows(rejected, first_error);
+    sort_by_time(trace);
+    return trace;
+}
+
+void save_trace_binary(ostream& out, const vector<TraceCall>& trace) {
+    uint32_t count = static_cast<uint32_t>(trace.size());
+    out.write("ELVT", 4);
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(trace.data()), streamsize(count * sizeof(TraceCall)));
+}
+
+// Loads by extension: ".bin" = binary, anything else = CSV.
+// Throws runtime_error if the file cannot be opened.
+vector<TraceCall> load_trace_file(const string& path, int num_floors = ElevatorCar::MAX_FLOORS) {
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    ifstream in(path, binary ? ios::binary : ios::in);
+    if (!in) throw runtime_error("cannot open trace file " + path);
+    return binary ? load_trace_binary(in, num_floors) : load_trace_csv(in, num_floors);
+}
+
+// Synthetic stand-in for a recorded trace. Each day is a morning up-peak
+// (most calls from the lobby) followed by an evening down-peak (most calls
+// from upper floors heading to the lobby).
+vector<TraceCall> generate_trace(int calls_per_day, int floors, int day_length, int days, unsigned seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> upper_floor(1, floors - 1), time_in_half(0, day_length / 2 - 1);
+    bernoulli_distribution peak_pattern(0.8);
+    vector<TraceCall> trace;
+    for (int d = 0; d < days; ++d) {
+        for (int i = 0; i < calls_per_day; ++i) {
+            bool morning = i % 2 == 0;
+            int time = d * day_length + (morning ? 0 : day_length / 2) + time_in_half(rng);
+            int origin, dest;
+            if (peak_pattern(rng)) {
+                origin = morning ? 0 : upper_floor(rng);
+                dest = morning ? upper_floor(rng) : 0;
+            } else {
+                origin = upper_floor(rng);
+                dest = upper_floor(rng);
+                if (dest == origin) dest = 0;
+            }
+            trace.push_back({time, origin, dest});
+        }
+    }
+    sort_by_time(trace);
+    return trace;
+}
+
+struct ReplayResult {
+    string dispatcher;
+    long long delivered = 0;
+    double avg_wait = 0, p95_wait = 0, avg_travel = 0;   // in steps
+    long long floors_moved = 0;                           // energy proxy
+    double dispatch_us_per_call = 0;
+};
+
+ReplayResult replay_trace(const vector<TraceCall>& trace, int num_cars, const string& name,
+                          unique_ptr<IDispatcher> dispatcher, unique_ptr<IIdlePolicy> idle_policy = nullptr,
+                          int max_steps = 100000) {
+    ElevatorSystem system(num_cars, move(dispatcher));
+    system.set_logging(false);
+    if (idle_policy) system.set_idle_policy(move(idle_policy));
+
+    // Door events are queued during step() and handled afterwards, so
+    // passenger logic never re-enters a car mid-step.
+    vector<pair<int, int>> door_events;
+    system.set_door_listener([&](int car, int floor) { door_events.push_back({car, floor}); });
+
+    struct Passenger { const TraceCall* call; int car; int boarded_at; };
+    vector<vector<Passenger>> waiting(num_cars + 1), riding(num_cars + 1);
+    vector<double> waits, travels;
+    double dispatch_ns = 0;
+
+    auto handle_doors = [&](int now) {
+        // Indexed loop: press_floor_button() may append events while we iterate
+        for (size_t k = 0; k < door_events.size(); ++k) {
+            auto [car, floor] = door_events[k];
+            auto& ride = riding[car];
+            for (size_t i = 0; i < ride.size();) {
+                if (ride[i].call->destination == floor) {
+                    travels.push_back(now - ride[i].boarded_at);
+                    ride[i] = ride.back();
+                    ride.pop_back();
+                } else ++i;
+            }
+            auto& wait = waiting[car];
+            for (size_t i = 0; i < wait.size();) {
+                if (wait[i].call->floor == floor) {
+                    waits.push_back(now - wait[i].call->time);
+                    wait[i].boarded_at = now;
+                    ride.push_back(wait[i]);
+                    system.press_floor_button(car, wait[i].call->destination);
+                    wait[i] = wait.back();
+                    wait.pop_back();
+                } else ++i;
+            }
+        }
+        door_events.clear();
+    };
+
+    size_t next = 0;
+    vector<Request> batch;
+    vector<const TraceCall*> batch_calls;
+    for (int now = 0; now < max_steps; ++now) {
+        batch.clear();
+        batch_calls.clear();
+        for (; next < trace.size() && trace[next].time <= now; ++next) {
+            const TraceCall& c = trace[next];
+            batch.emplace_back(c.floor, c.destination > c.floor ? Direction::UP : Direction::DOWN);
+            batch_calls.push_back(&c);
+        }
+        if (!batch.empty()) {
+            auto start = chrono::steady_clock::now();
+            vector<int> cars = system.handle_requests(batch);
+            dispatch_ns += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            for (size_t i = 0; i < cars.size(); ++i)
+                if (cars[i]) waiting[cars[i]].push_back({batch_calls[i], cars[i], -1});
+            handle_doors(now);   // a car may already be at the caller's floor
+        }
+
+        system.simulate_steps(1);
+        handle_doors(now + 1);
+
+        if (next == trace.size() && travels.size() == trace.size()) break;
+    }
+
+    ReplayResult r;
+    r.dispatcher = name;
+    r.delivered = static_cast<long long>(travels.size());
+    if (!waits.empty()) {
+        double sum = 0;
+        for (double w : waits) sum += w;
+        r.avg_wait = sum / waits.size();
+        size_t k = waits.size() * 95 / 100;
+        nth_element(waits.begin(), waits.begin() + k, waits.end());
+        r.p95_wait = waits[k];
+    }
+    if (!travels.empty()) {
+        double sum = 0;
+        for (double t : travels) sum += t;
+        r.avg_travel = sum / travels.size();
+    }
+    r.floors_moved = system.total_floors_moved();
+    if (!trace.empty()) r.dispatch_us_per_call = dispatch_ns / 1000.0 / trace.size();
+    return r;
+}
+
+struct ReplayStrategy {
+    string name;
+    function<unique_ptr<IDispatcher>()> make_dispatcher;
+    function<unique_ptr<IIdlePolicy>()> make_idle_policy = nullptr;   // optional
+};
+
+// Replays the same trace with every strategy, one thread each
+vector<ReplayResult> run_replay_batch(const vector<TraceCall>& trace, int num_cars,
+                                      const vector<ReplayStrategy>& strategies) {
+    vector<ReplayResult> results(strategies.size());
+    vector<thread> workers;
+    for (size_t i = 0; i < strategies.size(); ++i) {
+        workers.emplace_back([&, i] {
+            const ReplayStrategy& st = strategies[i];
+            results[i] = replay_trace(trace, num_cars, st.name, st.make_dispatcher(),
+                                      st.make_idle_policy ? st.make_idle_policy() : nullptr);
+        });
+    }
+    for (auto& w : workers) w.join();
+    return results;
+}
+
+void print_replay_results(const vector<ReplayResult>& results, size_t trace_size) {
+    cout << "  dispatcher        | delivered | avg wait | p95 wait | avg travel | floors moved | dispatch us/call\n";
+    for (const auto& r : results) {
+        cout << fixed << setprecision(1) << "  " << left << setw(17) << r.dispatcher << right
+             << " | " << setw(4) << r.delivered << "/" << setw(4) << trace_size
+             << " | " << setw(8) << r.avg_wait << " | " << setw(8) << r.p95_wait
+             << " | " << setw(10) << r.avg_travel << " | " << setw(12) << r.floors_moved
+             << " | " << setw(16) << setprecision(2) << r.dispatch_us_per_call << "\n";
+    }
+}
+
 // ==========================================
 // MAIN
 // ==========================================
-int main() {
+int main(int argc, char* argv[]) {
     // Create a system with 3 elevators and a NearestDispatcher strategy
     ElevatorSystem system(3, make_unique<NearestDispatcher>());
 
@@ -205,5 +1470,54 @@ int main() {
 
     system.print_status();
 
+    cout << "\n=== Concurrent Controller (Actor per Car) ===\n";
+    demo_concurrent_controller();
+
+    cout << "\n=== Trace Replay ===\n";
+    vector<TraceCall> trace;
+    int trace_floors = 30;              // parking model shape: building height
+    long long day_length = 1200;        // and steps per day
+    if (argc > 1) {
+        try {
+            trace = load_trace_file(argv[1]);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        cout << "Loaded " << trace.size() << " hall calls from " << argv[1] << "\n";
+        // A recorded trace carries no day length: learn over its whole span
+        trace_floors = 1;
+        day_length = 1;
+        for (const auto& c : trace) {
+            trace_floors = max({trace_floors, c.floor + 1, c.destination + 1});
+            day_length = max(day_length, static_cast<long long>(c.time) + 1);
+        }
+    } else {
+        // No trace given: round-trip a synthetic one through the CSV format
+        stringstream csv;
+        save_trace_csv(csv, generate_trace(400, 30, 1200, 3, 11));
+        trace = load_trace_csv(csv);
+        cout << "Synthetic trace: " << trace.size() << " hall calls over 3 days, 30 floors, 8 cars\n";
+    }
+    print_replay_results(run_replay_batch(trace, 8, {
+        {"Nearest", [] { return make_unique<NearestDispatcher>(); }},
+        {"Cost (batched)", [] { return make_unique<CostDispatcher>(); }},
+        {"Nearest + parking", [] { return make_unique<NearestDispatcher>(); },
+            [=] { return make_unique<PredictiveParking>(trace_floors, day_length); }},
+    }), trace.size());
+
+    cout << "\n=== Dispatcher Benchmark ===\n";
+    benchmark_dispatchers();
+
+    // Large what-if run on the event-driven engine (no per-move logging)
+    cout << "\n=== Event-Driven Campus Simulation ===\n";
+    CampusConfig campus;
+    print_campus_stats(campus, CampusSimulator(campus).run());
+
+    // Same traffic with the original first-come-first-served stop order
+    CampusConfig fifo_campus = campus;
+    fifo_campus.stop_policy = StopPolicy::FIFO;
+    print_campus_stats(fifo_campus, CampusSimulator(fifo_campus).run());
+
     return 0;
 }
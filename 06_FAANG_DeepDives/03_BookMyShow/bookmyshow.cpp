@@ -4,6 +4,25 @@
 #include <mutex>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <queue>
+#include <map>
+#include <cstring>
+#include <cctype>
+#include <stdexcept>
+#include <filesystem>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -23,60 +42,325 @@ struct Movie {
     int duration_min;
 };
 
-struct Seat {
-    int row;
-    int col;
-    SeatType type;
-    SeatStatus status = SeatStatus::AVAILABLE;
-    int price;
-    mutex seat_lock; // Critical: Per-seat mutex for thread safety!
+// ==========================================
+// SEAT MAP (Packed 2-bit seat states)
+// ==========================================
+// A shared_ptr<Seat> with its own mutex per seat means a 5,000-seat stadium
+// costs 5,000 heap objects and 5,000 mutexes, and rendering availability
+// chases 5,000 pointers. Instead each show keeps ONE contiguous array of
+// atomic words, 2 bits per seat (32 seats per word). Every row starts on a
+// fresh word, so a block of seats in one row usually lives in one word.
+// State changes are lock-free compare-and-swap on that word.
+class SeatMap {
+public:
+    static constexpr int BITS_PER_SEAT = 2;
+    static constexpr int SEATS_PER_WORD = 64 / BITS_PER_SEAT;
+    static constexpr uint64_t STATE_MASK = (1ULL << BITS_PER_SEAT) - 1;
+
+private:
+    int num_rows;
+    int num_cols;
+    int words_per_row;
+    unique_ptr<atomic<uint64_t>[]> words;   // all zero = all AVAILABLE
+    // Maintained by every transition below, so "how many seats are free?"
+    // is one load instead of a scan
+    alignas(64) atomic<int> available_seats;
+
+public:
+    SeatMap(int rows, int cols)
+        : num_rows(rows), num_cols(cols),
+          words_per_row((cols + SEATS_PER_WORD - 1) / SEATS_PER_WORD),
+          words(new atomic<uint64_t>[static_cast<size_t>(rows) * words_per_row]),
+          available_seats(rows * cols) {
+        for (int w = 0; w < rows * words_per_row; ++w) words[w].store(0, memory_order_relaxed);
+    }
+
+    int rows() const { return num_rows; }
+    int cols() const { return num_cols; }
+    int size() const { return num_rows * num_cols; }
+    int word_count() const { return num_rows * words_per_row; }
+    int available() const { return available_seats.load(memory_order_relaxed); }
+
+    // Seat index (row-major) → word and bit position
+    int word_of(int seat) const { return (seat / num_cols) * words_per_row + (seat % num_cols) / SEATS_PER_WORD; }
+    static int shift_of_col(int col) { return (col % SEATS_PER_WORD) * BITS_PER_SEAT; }
+    int shift_of(int seat) const { return shift_of_col(seat % num_cols); }
+
+    SeatStatus status(int seat) const {
+        uint64_t w = words[word_of(seat)].load(memory_order_acquire);
+        return static_cast<SeatStatus>((w >> shift_of(seat)) & STATE_MASK);
+    }
+
+    // Atomically move one seat from `from` to `to`; false if it wasn't `from`
+    bool transition(int seat, SeatStatus from, SeatStatus to) {
+        atomic<uint64_t>& word = words[word_of(seat)];
+        int shift = shift_of(seat);
+        uint64_t cur = word.load(memory_order_relaxed);
+        while (true) {
+            if (((cur >> shift) & STATE_MASK) != static_cast<uint64_t>(from)) return false;
+            uint64_t next = (cur & ~(STATE_MASK << shift)) | (static_cast<uint64_t>(to) << shift);
+            if (word.compare_exchange_weak(cur, next, memory_order_acq_rel, memory_order_relaxed)) {
+                if (from == SeatStatus::AVAILABLE) available_seats.fetch_sub(1, memory_order_relaxed);
+                if (to == SeatStatus::AVAILABLE) available_seats.fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    bool try_lock(int seat) { return transition(seat, SeatStatus::AVAILABLE, SeatStatus::LOCKED); }
+    bool confirm(int seat)  { return transition(seat, SeatStatus::LOCKED, SeatStatus::BOOKED); }
+    bool release(int seat)  { return transition(seat, SeatStatus::LOCKED, SeatStatus::AVAILABLE); }
+
+    // ---- All-or-nothing group operations ----
+    // A group of seats is split into one (word, mask) pair per touched word,
+    // sorted by word index. Every hold walks words in that same global order,
+    // so two overlapping holds always collide on their FIRST shared word and
+    // one of them backs off before claiming anything beyond it.
+    struct WordMask {
+        int word;
+        uint64_t seats;   // 0b11 in each targeted seat's slot
+    };
+
+    template <typename Seats>
+    vector<WordMask> group_by_word(const Seats& seats) const {
+        vector<WordMask> groups;
+        groups.reserve(seats.size());
+        for (int seat : seats) groups.push_back({word_of(seat), STATE_MASK << shift_of(seat)});
+        sort(groups.begin(), groups.end(), [](const WordMask& a, const WordMask& b) { return a.word < b.word; });
+        size_t out = 0;
+        for (size_t i = 0; i < groups.size(); ++i) {
+            if (out > 0 && groups[out - 1].word == groups[i].word) groups[out - 1].seats |= groups[i].seats;
+            else groups[out++] = groups[i];
+        }
+        groups.resize(out);
+        return groups;
+    }
+
+    // Low bit of each 2-bit slot: AVAILABLE(00) | lock_bits = LOCKED(01)
+    static uint64_t lock_bits(uint64_t seat_mask) { return seat_mask & 0x5555555555555555ULL; }
+    static int seats_in(uint64_t seat_mask) { return __builtin_popcountll(lock_bits(seat_mask)); }
 
-    Seat(int r, int c, SeatType t, int p) : row(r), col(c), type(t), price(p) {}
+    // Claims every seat or none. Seats sharing a row word flip with ONE CAS.
+    // Returns -1 on success, otherwise the index of a seat that was taken.
+    template <typename Seats>
+    int try_lock_all(const Seats& seats) {
+        vector<WordMask> groups = group_by_word(seats);
+        for (size_t g = 0; g < groups.size(); ++g) {
+            atomic<uint64_t>& word = words[groups[g].word];
+            uint64_t cur = word.load(memory_order_relaxed);
+            while (true) {
+                if (cur & groups[g].seats) {
+                    // Undo the words already claimed, newest first
+                    for (size_t u = g; u-- > 0;)
+                        words[groups[u].word].fetch_and(~lock_bits(groups[u].seats), memory_order_release);
+                    for (int seat : seats)
+                        if (word_of(seat) == groups[g].word && (cur & (STATE_MASK << shift_of(seat)))) return seat;
+                    return *seats.begin();
+                }
+                if (word.compare_exchange_weak(cur, cur | lock_bits(groups[g].seats),
+                                               memory_order_acq_rel, memory_order_relaxed)) break;
+            }
+        }
+        int held = 0;
+        for (const WordMask& g : groups) held += seats_in(g.seats);
+        available_seats.fetch_sub(held, memory_order_relaxed);
+        return -1;
+    }
+
+    // The caller owns these LOCKED seats, so plain fetch ops are safe:
+    // LOCKED(01) & ~01 = AVAILABLE(00);  LOCKED(01) ^ 11 = BOOKED(10)
+    template <typename Seats>
+    void release_all(const Seats& seats) {
+        int released = 0;
+        for (const WordMask& g : group_by_word(seats)) {
+            words[g.word].fetch_and(~lock_bits(g.seats), memory_order_release);
+            released += seats_in(g.seats);
+        }
+        available_seats.fetch_add(released, memory_order_relaxed);
+    }
 
-    string label() const {
-        return string(1, 'A' + row) + to_string(col);
+    template <typename Seats>
+    void confirm_all(const Seats& seats) {
+        for (const WordMask& g : group_by_word(seats))
+            words[g.word].fetch_xor(g.seats, memory_order_acq_rel);
     }
 
-    // Thread-safe seat locking
-    bool try_lock_seat() {
-        lock_guard<mutex> guard(seat_lock);
-        if (status == SeatStatus::AVAILABLE) {
-            status = SeatStatus::LOCKED;
-            cout << "  🔒 Seat " << label() << " LOCKED.\n";
-            return true;
+    // Linear scan over the contiguous words: decode 32 seats per load
+    template <typename Fn>
+    void for_each_status(Fn fn) const {
+        for (int r = 0; r < num_rows; ++r) {
+            for (int wi = 0; wi < words_per_row; ++wi) {
+                uint64_t w = words[r * words_per_row + wi].load(memory_order_acquire);
+                int first = wi * SEATS_PER_WORD;
+                int last = min(num_cols, first + SEATS_PER_WORD);
+                for (int c = first; c < last; ++c, w >>= BITS_PER_SEAT)
+                    fn(r * num_cols + c, static_cast<SeatStatus>(w & STATE_MASK));
+            }
         }
-        cout << "  ❌ Seat " << label() << " is already taken!\n";
-        return false;
     }
 
-    void confirm_booking() {
-        lock_guard<mutex> guard(seat_lock);
-        status = SeatStatus::BOOKED;
-        cout << "  ✅ Seat " << label() << " BOOKED.\n";
+    int count(SeatStatus st) const {
+        int n = 0;
+        for_each_status([&](int, SeatStatus s) { n += (s == st); });
+        return n;
     }
 
-    void release_lock() {
-        lock_guard<mutex> guard(seat_lock);
-        if (status == SeatStatus::LOCKED) {
-            status = SeatStatus::AVAILABLE;
-            cout << "  🔓 Seat " << label() << " released back to AVAILABLE.\n";
+    size_t bytes() const { return static_cast<size_t>(word_count()) * sizeof(uint64_t); }
+
+    // ---- Free-seat bitmaps (1 bit per seat) ----
+    int free_words_per_row() const { return (num_cols + 63) / 64; }
+
+    // Fills out[0..free_words_per_row()) with bit c set iff seat (row, c) is
+    // AVAILABLE. Each 2-bit word is folded to 32 bits with shift-or steps.
+    void free_bits(int row, uint64_t* out) const {
+        for (int i = 0; i < free_words_per_row(); ++i) out[i] = 0;
+        for (int wi = 0; wi < words_per_row; ++wi) {
+            uint64_t w = words[row * words_per_row + wi].load(memory_order_acquire);
+            uint64_t x = ~(w | (w >> 1)) & 0x5555555555555555ULL;   // 1 in each free slot
+            x = (x | (x >> 1)) & 0x3333333333333333ULL;
+            x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+            x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+            x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+            x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+            int first = wi * SEATS_PER_WORD;
+            int valid = min(SEATS_PER_WORD, num_cols - first);
+            if (valid < SEATS_PER_WORD) x &= (1ULL << valid) - 1;   // padding slots read as 00
+            out[first / 64] |= x << (first % 64);
         }
     }
 };
 
+// Per-row pricing: every seat in a row shares type and price
+struct RowInfo {
+    SeatType type;
+    int price;
+};
+
 struct Show {
+    int show_id = 0;     // assigned once, by the ShowCatalog (or whoever owns the shows)
+    int hall_id = 0;     // set by ShowCatalog
     Movie movie;
     string time_slot;
     string hall_name;
-    vector<shared_ptr<Seat>> seats;
-    
+    vector<RowInfo> rows;
+    SeatMap seat_map;
+    // Seat quality, precomputed once: prefix sums per row (cols + 1 entries)
+    // so any run [c, c + n) scores in O(1)
+    vector<double> score_prefix;
+
+    Show(Movie m, string slot, string hall, vector<RowInfo> row_info, int cols)
+        : movie(move(m)), time_slot(move(slot)), hall_name(move(hall)),
+          rows(move(row_info)), seat_map(static_cast<int>(rows.size()), cols) {
+        int num_rows = static_cast<int>(rows.size());
+        double ideal_row = (num_rows - 1) * 0.6;            // a bit behind the middle
+        double center = (cols - 1) / 2.0;
+        score_prefix.assign(static_cast<size_t>(num_rows) * (cols + 1), 0.0);
+        for (int r = 0; r < num_rows; ++r) {
+            double row_q = 1.0 - abs(r - ideal_row) / max(1.0, static_cast<double>(num_rows));
+            for (int c = 0; c < cols; ++c) {
+                double col_q = 1.0 - abs(c - center) / max(1.0, static_cast<double>(cols));
+                score_prefix[r * (cols + 1) + c + 1] = score_prefix[r * (cols + 1) + c] + row_q * 2.0 + col_q;
+            }
+        }
+    }
+
+    double run_score(int row, int col, int len) const {
+        const double* p = &score_prefix[row * (seat_map.cols() + 1)];
+        return p[col + len] - p[col];
+    }
+
+    int seat_index(int row, int col) const { return row * seat_map.cols() + col; }
+    int seat_price(int seat) const { return rows[seat / seat_map.cols()].price; }
+
+    // "A1", "B12", ... "AA3" for very large venues
+    string seat_label(int seat) const {
+        int row = seat / seat_map.cols(), col = seat % seat_map.cols();
+        string name;
+        for (int r = row + 1; r > 0; r = (r - 1) / 26) name.insert(name.begin(), char('A' + (r - 1) % 26));
+        return name + to_string(col + 1);
+    }
+
     void display_seats() const {
         cout << "\n--- Seats for " << movie.title << " @ " << time_slot << " ---\n";
-        for (const auto& s : seats) {
-            char status_char = (s->status == SeatStatus::AVAILABLE) ? 'O' : 'X';
-            cout << "[" << s->label() << ":" << status_char << "] ";
+        seat_map.for_each_status([&](int seat, SeatStatus st) {
+            char status_char = (st == SeatStatus::AVAILABLE) ? 'O' : 'X';
+            cout << "[" << seat_label(seat) << ":" << status_char << "] ";
+            if ((seat + 1) % seat_map.cols() == 0) cout << "\n";
+        });
+    }
+};
+
+// ==========================================
+// BEST AVAILABLE SEAT FINDER
+// ==========================================
+// "Give me the best 4 seats together": snapshot each row's free bitmap,
+// find every start of a free run of length n with shift-AND
+// (starts &= free >> k for k < n), and score each candidate from the
+// prefix sums. If no row has n together, split the party into the best
+// smaller runs. The result is only a proposal: the caller claims it with
+// try_lock_all and re-plans if another fan won the race.
+class SeatFinder {
+private:
+    const Show& show;
+    int rows, cols, words;
+    vector<uint64_t> free_map;   // rows x words, local snapshot
+
+    uint64_t* row_bits(int r) { return &free_map[static_cast<size_t>(r) * words]; }
+
+    // Best run of exactly `len` free seats across all rows; false if none
+    bool best_run(int len, int& best_row, int& best_col) {
+        double best = -1e18;
+        vector<uint64_t> starts(words);
+        for (int r = 0; r < rows; ++r) {
+            const uint64_t* bits = row_bits(r);
+            for (int i = 0; i < words; ++i) starts[i] = bits[i];
+            for (int k = 1; k < len; ++k) {
+                // starts &= bits >> k (multi-word shift)
+                for (int i = 0; i < words; ++i) {
+                    int wshift = k / 64, bshift = k % 64;
+                    uint64_t lo = (i + wshift < words) ? bits[i + wshift] : 0;
+                    uint64_t hi = (i + wshift + 1 < words) ? bits[i + wshift + 1] : 0;
+                    uint64_t shifted = bshift ? ((lo >> bshift) | (hi << (64 - bshift))) : lo;
+                    starts[i] &= shifted;
+                }
+            }
+            for (int i = 0; i < words; ++i) {
+                for (uint64_t m = starts[i]; m; m &= m - 1) {
+                    int c = i * 64 + __builtin_ctzll(m);
+                    double score = show.run_score(r, c, len);
+                    if (score > best) { best = score; best_row = r; best_col = c; }
+                }
+            }
         }
-        cout << "\n";
+        return best > -1e18;
+    }
+
+public:
+    explicit SeatFinder(const Show& show)
+        : show(show), rows(show.seat_map.rows()), cols(show.seat_map.cols()),
+          words(show.seat_map.free_words_per_row()) {}
+
+    // Returns seat indices for the party, or empty if not enough free seats
+    vector<int> find(int party, bool* split = nullptr) {
+        free_map.assign(static_cast<size_t>(rows) * words, 0);
+        for (int r = 0; r < rows; ++r) show.seat_map.free_bits(r, row_bits(r));
+
+        vector<int> seats;
+        int need = party, len = party, runs = 0;
+        while (need > 0 && len > 0) {
+            int r, c;
+            if (!best_run(len, r, c)) { --len; continue; }
+            for (int k = 0; k < len; ++k) {
+                seats.push_back(r * cols + c + k);
+                row_bits(r)[(c + k) / 64] &= ~(1ULL << ((c + k) % 64));
+            }
+            need -= len;
+            len = min(len, need);
+            ++runs;
+        }
+        if (split) *split = runs > 1;
+        if (need > 0) seats.clear();
+        return seats;
     }
 };
 
@@ -106,23 +390,249 @@ public:
 };
 
 // ==========================================
-// BOOKING
+// PAYMENT GATEWAY (async, fake latency)
+// ==========================================
+// A real gateway call is a network round-trip of tens to hundreds of ms.
+// Calling IPaymentStrategy::pay inline blocks the booking thread for all of
+// it. The gateway runs charges on its own pool of "connections" and reports
+// back through a callback, so the booking thread only does the CPU work.
+class PaymentGateway {
+private:
+    struct Charge {
+        shared_ptr<IPaymentStrategy> method;   // null = nothing to charge, report failure
+        int amount;
+        function<void(bool)> on_done;
+    };
+
+    chrono::microseconds latency;
+    double failure_rate;
+    mutex mtx;
+    condition_variable cv;
+    queue<Charge> pending;
+    vector<thread> connections;
+    bool stopping = false;
+
+    void run(unsigned seed) {
+        mt19937 rng(seed);
+        uniform_real_distribution<double> roll(0.0, 1.0);
+        while (true) {
+            Charge charge;
+            {
+                unique_lock<mutex> lk(mtx);
+                cv.wait(lk, [&] { return stopping || !pending.empty(); });
+                if (pending.empty()) return;
+                charge = move(pending.front());
+                pending.pop();
+            }
+            if (!charge.method) {
+                charge.on_done(false);
+                continue;
+            }
+            this_thread::sleep_for(latency);                // network round-trip
+            bool ok = roll(rng) >= failure_rate && charge.method->pay(charge.amount);
+            charge.on_done(ok);
+        }
+    }
+
+public:
+    PaymentGateway(int num_connections, chrono::microseconds latency, double failure_rate = 0.0)
+        : latency(latency), failure_rate(failure_rate) {
+        for (int i = 0; i < num_connections; ++i)
+            connections.emplace_back([this, i] { run(static_cast<unsigned>(i) + 1); });
+    }
+
+    // Drains in-flight charges before shutting down
+    ~PaymentGateway() {
+        {
+            lock_guard<mutex> guard(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& c : connections) c.join();
+    }
+
+    void charge(unique_ptr<IPaymentStrategy> method, int amount, function<void(bool)> on_done) {
+        {
+            lock_guard<mutex> guard(mtx);
+            pending.push({shared_ptr<IPaymentStrategy>(move(method)), amount, move(on_done)});
+        }
+        cv.notify_one();
+    }
+
+    // on_done(false) on a gateway thread, with no charge: lets callers keep
+    // "callbacks never run inline" even for requests that fail up front
+    void decline(function<void(bool)> on_done) {
+        {
+            lock_guard<mutex> guard(mtx);
+            pending.push({nullptr, 0, move(on_done)});
+        }
+        cv.notify_one();
+    }
+};
+
+// ==========================================
+// BOOKING (pooled, inline seat list)
 // ==========================================
+// A booking never has more than MAX_SEATS_PER_BOOKING seats, so the seat
+// indices live inline in the Booking instead of in a separately allocated
+// vector. One booking = one allocation, and that one comes from a pool.
+constexpr int MAX_SEATS_PER_BOOKING = 10;
+
+class SeatList {
+private:
+    int32_t seats[MAX_SEATS_PER_BOOKING];
+    int32_t count = 0;
+
+public:
+    SeatList() = default;
+    explicit SeatList(const vector<int>& v) {
+        for (int s : v) push_back(s);
+    }
+
+    void push_back(int seat) { seats[count++] = seat; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const int32_t* begin() const { return seats; }
+    const int32_t* end() const { return seats + count; }
+};
+
+// Fixed-size slot allocator owned by one thread (a booking shard). The
+// owner allocates and frees without atomics; other threads (clients that
+// delete their Booking) push slots onto a lock-free "remote free" stack,
+// which the owner takes wholesale with one exchange when it runs dry.
+// Only the owner ever pops, so the Treiber stack has no ABA problem.
+// The slot memory lives in a refcounted Arena: one reference for the pool,
+// one per slot handed out. A Booking freed after its pool is gone just
+// drops the last references, and the last free releases the chunks.
+class BookingPool {
+public:
+    class Arena;
+    struct Header {                  // precedes every Booking allocation
+        Arena* arena;                // nullptr = plain heap allocation
+        size_t pad;
+    };
+    static constexpr size_t CHUNK_SLOTS = 256;
+
+    class Arena {
+        friend class BookingPool;
+        struct FreeSlot { FreeSlot* next; };
+        size_t slot_size;
+        vector<unique_ptr<char[]>> chunks;
+        FreeSlot* local_free = nullptr;
+        atomic<FreeSlot*> remote_free{nullptr};
+        atomic<long> refs{1};        // the owning pool + every live slot
+        long pooled = 0, recycled_remote = 0;
+
+        explicit Arena(size_t slot_size) : slot_size(slot_size) {}
+
+        // Owner thread only
+        void* allocate() {
+            if (!local_free) {
+                local_free = remote_free.exchange(nullptr, memory_order_acquire);
+                if (local_free) ++recycled_remote;
+            }
+            if (!local_free) {
+                chunks.emplace_back(new char[slot_size * CHUNK_SLOTS]);
+                char* base = chunks.back().get();
+                for (size_t i = CHUNK_SLOTS; i-- > 0;) {
+                    auto* slot = reinterpret_cast<FreeSlot*>(base + i * slot_size);
+                    slot->next = local_free;
+                    local_free = slot;
+                }
+            }
+            FreeSlot* slot = local_free;
+            local_free = slot->next;
+            ++pooled;
+            refs.fetch_add(1, memory_order_relaxed);
+            return slot;
+        }
+
+        void unref() {
+            if (refs.fetch_sub(1, memory_order_acq_rel) == 1) delete this;
+        }
+
+    public:
+        // Any thread, even after the owning pool was destroyed
+        void deallocate(void* p) {
+            auto* slot = static_cast<FreeSlot*>(p);
+            if (current && current->arena == this) {
+                slot->next = local_free;
+                local_free = slot;
+            } else {
+                slot->next = remote_free.load(memory_order_relaxed);
+                while (!remote_free.compare_exchange_weak(slot->next, slot, memory_order_release, memory_order_relaxed)) {}
+            }
+            unref();
+        }
+    };
+
+private:
+    Arena* arena;
+
+    static thread_local BookingPool* current;
+
+public:
+    explicit BookingPool(size_t object_size)
+        : arena(new Arena((sizeof(Header) + object_size + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t))) {}
+
+    ~BookingPool() {
+        if (current == this) current = nullptr;
+        arena->unref();              // slots still out keep the arena alive
+    }
+
+    BookingPool(const BookingPool&) = delete;
+    BookingPool& operator=(const BookingPool&) = delete;
+
+    // Booking::operator new on this thread now draws from this pool
+    void bind_to_current_thread() { current = this; }
+    static void unbind_current_thread() { current = nullptr; }
+    static BookingPool* for_current_thread() { return current; }
+
+    // Owner thread only; returns a slot with its Header filled in
+    void* allocate() {
+        void* raw = arena->allocate();
+        static_cast<Header*>(raw)->arena = arena;
+        return raw;
+    }
+
+    long allocations() const { return arena->pooled; }
+    size_t chunk_count() const { return arena->chunks.size(); }
+};
+
+thread_local BookingPool* BookingPool::current = nullptr;
+
 struct Booking {
     int booking_id;
     string user_name;
     Show* show;
-    vector<shared_ptr<Seat>> booked_seats;
+    SeatList seat_indices;
     int total_price = 0;
     BookingStatus status = BookingStatus::PENDING;
 
+    // Route `new Booking` to the calling thread's pool (if it has one), and
+    // `delete` back to whichever pool the slot came from, from any thread.
+    static void* operator new(size_t size) {
+        BookingPool* pool = BookingPool::for_current_thread();
+        if (pool) return static_cast<BookingPool::Header*>(pool->allocate()) + 1;
+        auto* header = static_cast<BookingPool::Header*>(::operator new(sizeof(BookingPool::Header) + size));
+        header->arena = nullptr;
+        return header + 1;
+    }
+
+    static void operator delete(void* p) {
+        if (!p) return;
+        auto* header = static_cast<BookingPool::Header*>(p) - 1;
+        if (header->arena) header->arena->deallocate(header);
+        else ::operator delete(header);
+    }
+
     void print_ticket() const {
         cout << "\n🎬 ========= TICKET =========\n";
         cout << "Booking ID: " << booking_id << "\n";
         cout << "Movie: " << show->movie.title << "\n";
         cout << "Time: " << show->time_slot << " | Hall: " << show->hall_name << "\n";
         cout << "Seats: ";
-        for (const auto& s : booked_seats) cout << s->label() << " ";
+        for (int idx : seat_indices) cout << show->seat_label(idx) << " ";
         cout << "\nTotal: $" << total_price << "\n";
         cout << "Status: CONFIRMED ✅\n";
         cout << "============================\n";
@@ -130,97 +640,1780 @@ struct Booking {
 };
 
 // ==========================================
-// BOOKING MANAGER (Controller / Facade)
+// BOOKING JOURNAL (write-ahead log, group commit)
 // ==========================================
-class BookingManager {
-private:
-    int next_booking_id = 1000;
+// Seat maps live in memory; a crash must not lose a confirmed ticket. Every
+// confirmation appends a fixed-size record to an append-only file and the
+// ticket is only handed out once that record is on disk. fdatasync costs
+// ~0.1-10 ms, so syncing per booking caps throughput at a few hundred
+// bookings/s. Group commit: confirmers append to a shared buffer and wait;
+// a flusher thread writes everything gathered within a short window and
+// makes it durable with ONE fdatasync, waking every waiter in the batch.
+// A failed write or fdatasync is sticky: after it the kernel may already
+// have dropped the dirty pages, so retrying could report data as durable
+// that never reached disk. Every pending and later commit throws instead.
+struct JournalRecord {
+    static constexpr uint32_t MAGIC = 0x424B4E47;   // "BKNG"
+    uint32_t magic = MAGIC;
+    int32_t show_id = 0;
+    int32_t booking_id = 0;
+    int32_t seat_count = 0;
+    int32_t seats[MAX_SEATS_PER_BOOKING] = {};
+    uint32_t checksum = 0;
+
+    // FNV-1a over everything before the checksum: detects torn tail writes
+    uint32_t compute_checksum() const {
+        uint32_t h = 2166136261u;
+        const auto* bytes = reinterpret_cast<const unsigned char*>(this);
+        for (size_t i = 0; i < offsetof(JournalRecord, checksum); ++i) h = (h ^ bytes[i]) * 16777619u;
+        return h;
+    }
+};
+
+class BookingJournal {
 public:
-    Booking* create_booking(const string& user, Show* show, 
-                            vector<int> seat_indices, 
-                            unique_ptr<IPaymentStrategy> payment) {
-        
-        cout << "\n--- " << user << " attempting to book ---\n";
-        
-        // Step 1: Lock the requested seats
-        vector<shared_ptr<Seat>> locked_seats;
-        for (int idx : seat_indices) {
-            if (show->seats[idx]->try_lock_seat()) {
-                locked_seats.push_back(show->seats[idx]);
-            } else {
-                // Rollback: Release all already-locked seats
-                cout << "  ⚠️ Booking failed! Rolling back...\n";
-                for (auto& s : locked_seats) s->release_lock();
-                return nullptr;
+    enum class CommitMode { SYNC_EACH, GROUP };
+
+private:
+    int fd;
+    CommitMode mode;
+    chrono::microseconds window;
+    mutex mtx;
+    condition_variable flush_cv, durable_cv;
+    vector<char> buffer;                 // records not yet written
+    uint64_t next_lsn = 1;               // log sequence number of the next append
+    uint64_t durable_lsn = 0;            // everything <= this is on disk
+    long syncs = 0, records = 0;
+    thread flusher;
+    bool stopping = false;
+    string failure;                      // non-empty once a write/sync failed
+
+    // Returns an error message, or "" once data is written and synced
+    string write_and_sync(const char* data, size_t len) {
+        while (len > 0) {
+            ssize_t n = ::write(fd, data, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return string("journal write failed: ") + strerror(errno);
             }
+            data += n;
+            len -= static_cast<size_t>(n);
         }
+        if (::fdatasync(fd) != 0) return string("journal fdatasync failed: ") + strerror(errno);
+        return "";
+    }
 
-        // Step 2: Calculate total price
-        int total = 0;
-        for (auto& s : locked_seats) total += s->price;
+    void flush_loop() {
+        vector<char> batch;
+        unique_lock<mutex> lk(mtx);
+        while (true) {
+            flush_cv.wait(lk, [&] { return stopping || !buffer.empty(); });
+            if (buffer.empty()) return;
+            // Let more confirmations join this batch (group commit window)
+            if (window.count() > 0)
+                flush_cv.wait_for(lk, window, [&] { return stopping; });
+            batch.swap(buffer);
+            uint64_t upto = next_lsn - 1;
+            lk.unlock();
+            string error = write_and_sync(batch.data(), batch.size());
+            batch.clear();
+            lk.lock();
+            ++syncs;
+            if (!error.empty()) {
+                // Fail this batch and everything queued behind it; stop flushing
+                failure = move(error);
+                buffer.clear();
+                durable_cv.notify_all();
+                return;
+            }
+            durable_lsn = upto;
+            durable_cv.notify_all();
+        }
+    }
 
-        // Step 3: Process payment
-        cout << "  Processing payment of $" << total << "...\n";
-        if (!payment->pay(total)) {
-            cout << "  ⚠️ Payment FAILED! Releasing seats.\n";
-            for (auto& s : locked_seats) s->release_lock();
-            return nullptr;
+public:
+    BookingJournal(const string& path, CommitMode mode = CommitMode::GROUP,
+                   chrono::microseconds window = chrono::microseconds(200))
+        : fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644)), mode(mode), window(window) {
+        if (fd < 0) throw runtime_error("cannot open journal " + path);
+        if (mode == CommitMode::GROUP) flusher = thread([this] { flush_loop(); });
+    }
+
+    ~BookingJournal() {
+        {
+            lock_guard<mutex> guard(mtx);
+            stopping = true;
         }
+        flush_cv.notify_all();
+        if (flusher.joinable()) flusher.join();
+        ::close(fd);
+    }
 
-        // Step 4: Confirm booking
-        for (auto& s : locked_seats) s->confirm_booking();
+    // Returns once the record is durable; throws if it cannot be made durable
+    void commit(const Booking& booking) {
+        JournalRecord rec;
+        rec.show_id = booking.show->show_id;
+        rec.booking_id = booking.booking_id;
+        for (int seat : booking.seat_indices) rec.seats[rec.seat_count++] = seat;
+        rec.checksum = rec.compute_checksum();
 
-        Booking* booking = new Booking();
-        booking->booking_id = next_booking_id++;
-        booking->user_name = user;
-        booking->show = show;
-        booking->booked_seats = locked_seats;
-        booking->total_price = total;
-        booking->status = BookingStatus::CONFIRMED;
+        unique_lock<mutex> lk(mtx);
+        if (!failure.empty()) throw runtime_error(failure);
+        if (mode == CommitMode::SYNC_EACH) {
+            string error = write_and_sync(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            ++syncs;
+            if (!error.empty()) {
+                failure = error;
+                throw runtime_error(error);
+            }
+            ++records;
+            return;
+        }
+        buffer.insert(buffer.end(), reinterpret_cast<const char*>(&rec),
+                      reinterpret_cast<const char*>(&rec) + sizeof(rec));
+        uint64_t lsn = next_lsn++;
+        flush_cv.notify_one();
+        durable_cv.wait(lk, [&] { return durable_lsn >= lsn || !failure.empty(); });
+        if (durable_lsn < lsn) throw runtime_error(failure);
+        ++records;
+    }
 
-        return booking;
+    long sync_count() {
+        lock_guard<mutex> guard(mtx);
+        return syncs;
+    }
+
+    long record_count() {
+        lock_guard<mutex> guard(mtx);
+        return records;
+    }
+
+    // Why commits are failing ("" while the journal is healthy)
+    string error() {
+        lock_guard<mutex> guard(mtx);
+        return failure;
+    }
+
+    // Calls apply(record) for every intact record; stops at a torn tail and
+    // truncates the file there, so records appended after a restart (the
+    // journal opens with O_APPEND) are not stranded behind the garbage.
+    // Returns the number of records replayed; 0 if there is no journal yet.
+    // Any other open failure throws: an unreadable journal is not an empty one.
+    template <typename Fn>
+    static int replay(const string& path, Fn apply) {
+        int in = ::open(path.c_str(), O_RDWR);
+        if (in < 0) {
+            if (errno == ENOENT) return 0;
+            throw runtime_error("cannot open journal " + path + ": " + strerror(errno));
+        }
+        int replayed = 0;
+        off_t intact = 0;
+        JournalRecord rec;
+        while (::read(in, &rec, sizeof(rec)) == static_cast<ssize_t>(sizeof(rec))) {
+            if (rec.magic != JournalRecord::MAGIC || rec.checksum != rec.compute_checksum() ||
+                rec.seat_count < 0 || rec.seat_count > MAX_SEATS_PER_BOOKING) break;
+            apply(rec);
+            ++replayed;
+            intact += static_cast<off_t>(sizeof(rec));
+        }
+        if (::lseek(in, 0, SEEK_END) > intact) {
+            if (::ftruncate(in, intact) != 0 || ::fdatasync(in) != 0) {
+                ::close(in);
+                throw runtime_error("cannot truncate torn journal tail in " + path);
+            }
+        }
+        ::close(in);
+        return replayed;
     }
 };
 
 // ==========================================
-// MAIN
+// HOLD TIMER (Hierarchical Timing Wheel)
 // ==========================================
-int main() {
-    // Setup
-    Movie avengers{"Avengers: Endgame", "Action", 181};
-    
-    Show show;
-    show.movie = avengers;
-    show.time_slot = "7:00 PM";
-    show.hall_name = "Screen 1";
-    
-    // Create seats (2 rows x 5 cols)
-    for (int r = 0; r < 2; r++) {
-        for (int c = 1; c <= 5; c++) {
-            SeatType type = (r == 0) ? SeatType::VIP : SeatType::REGULAR;
-            int price = (type == SeatType::VIP) ? 15 : 10;
-            show.seats.push_back(make_shared<Seat>(r, c, type, price));
+// Every seat hold needs a TTL. A priority queue makes arm/cancel O(log n);
+// a timing wheel makes both O(1): 4 levels x 64 slots, each slot an
+// intrusive doubly-linked list of timer nodes. Level 0 slots are single
+// ticks; a level-L slot spans 64^L ticks and is "cascaded" down into finer
+// slots when the wheel's clock reaches it. 64^4 ticks ~ 19 days at 100 ms.
+class TimerWheel {
+public:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr int LEVELS = 4;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t MAX_SPAN = (1ULL << (SLOT_BITS * LEVELS)) - 1;
+
+private:
+    struct Node {
+        uint64_t expiry = 0;
+        int payload = 0;
+        int prev = -1, next = -1;
+        int level = -1, slot = -1;   // -1 = not armed (free)
+    };
+    vector<Node> nodes;              // timer id = index; reused via free list
+    vector<int> free_ids;
+    int heads[LEVELS][SLOTS];
+    uint64_t current = 0;
+    int armed = 0;
+
+    void link(int id) {
+        Node& n = nodes[id];
+        // Level = how many high-order slot groups differ from "now"
+        uint64_t diff = n.expiry ^ current;
+        int level = 0;
+        while (level < LEVELS - 1 && (diff >> (SLOT_BITS * (level + 1))) != 0) ++level;
+        n.level = level;
+        n.slot = static_cast<int>((n.expiry >> (SLOT_BITS * level)) & SLOT_MASK);
+        n.prev = -1;
+        n.next = heads[level][n.slot];
+        if (n.next >= 0) nodes[n.next].prev = id;
+        heads[level][n.slot] = id;
+    }
+
+    void unlink(int id) {
+        Node& n = nodes[id];
+        if (n.prev >= 0) nodes[n.prev].next = n.next;
+        else heads[n.level][n.slot] = n.next;
+        if (n.next >= 0) nodes[n.next].prev = n.prev;
+        n.level = n.slot = n.prev = n.next = -1;
+    }
+
+    // Re-insert every node of a coarse slot; they land in finer levels
+    void cascade(int level, int slot) {
+        int id = heads[level][slot];
+        heads[level][slot] = -1;
+        while (id >= 0) {
+            int next = nodes[id].next;
+            link(id);
+            id = next;
         }
     }
 
-    show.display_seats();
+public:
+    TimerWheel() {
+        for (auto& level : heads)
+            for (int& h : level) h = -1;
+    }
 
-    BookingManager manager;
+    uint64_t now() const { return current; }
+    int pending() const { return armed; }
 
-    // User 1 books VIP seats A1, A2
-    Booking* b1 = manager.create_booking("Alice", &show, {0, 1}, make_unique<CreditCardPayment>());
-    if (b1) b1->print_ticket();
+    // O(1): take a node, compute its slot, push on that slot's list
+    int arm_at(uint64_t expiry_tick, int payload) {
+        int id;
+        if (!free_ids.empty()) { id = free_ids.back(); free_ids.pop_back(); }
+        else { id = static_cast<int>(nodes.size()); nodes.emplace_back(); }
+        expiry_tick = max(expiry_tick, current + 1);
+        nodes[id].expiry = min(expiry_tick, current + MAX_SPAN);
+        nodes[id].payload = payload;
+        link(id);
+        ++armed;
+        return id;
+    }
 
-    // User 2 tries to book seat A1 (already taken!)
-    Booking* b2 = manager.create_booking("Bob", &show, {0, 4}, make_unique<UPIPayment>());
-    if (b2) b2->print_ticket();
+    // O(1): unlink from whatever slot it sits in
+    bool cancel(int id) {
+        if (id < 0 || id >= static_cast<int>(nodes.size()) || nodes[id].level < 0) return false;
+        unlink(id);
+        free_ids.push_back(id);
+        --armed;
+        return true;
+    }
 
-    // User 3 tries the SAME seat as Alice → should FAIL
-    Booking* b3 = manager.create_booking("Charlie", &show, {0}, make_unique<CreditCardPayment>());
-    if (!b3) cout << "Charlie's booking failed as expected.\n";
+    // Move the clock forward, calling on_expire(payload) for each due timer
+    template <typename Fn>
+    void advance(uint64_t to_tick, Fn on_expire) {
+        while (current < to_tick) {
+            if (armed == 0) { current = to_tick; break; }
+            ++current;
+            // Cascade coarsest-first when the lower digits roll over to 0
+            int top = 0;
+            while (top + 1 < LEVELS && (current & ((1ULL << (SLOT_BITS * (top + 1))) - 1)) == 0) ++top;
+            for (int level = top; level >= 1; --level)
+                cascade(level, static_cast<int>((current >> (SLOT_BITS * level)) & SLOT_MASK));
 
-    show.display_seats();
+            int slot = static_cast<int>(current & SLOT_MASK);
+            while (heads[0][slot] >= 0) {
+                int id = heads[0][slot];
+                int payload = nodes[id].payload;
+                unlink(id);
+                free_ids.push_back(id);
+                --armed;
+                on_expire(payload);
+            }
+        }
+    }
+};
 
-    delete b1; delete b2;
+// ==========================================
+// BOOKING ID ALLOCATION (lock-free ranges)
+// ==========================================
+// One global atomic counter touched on every booking is a shared cache line
+// bouncing between every core. Instead a shard grabs a BLOCK of ids with a
+// single fetch_add and hands them out locally; the global counter is touched
+// once per 1,024 bookings. Ids stay unique, just not globally ordered.
+class BookingIdAllocator {
+private:
+    alignas(64) atomic<int> next_block_start;
+    int block_size;
+
+public:
+    explicit BookingIdAllocator(int first_id = 1000, int block_size = 1024)
+        : next_block_start(first_id), block_size(block_size) {}
+
+    // Returns [start, start + block_size)
+    pair<int, int> claim_block() {
+        int start = next_block_start.fetch_add(block_size, memory_order_relaxed);
+        return {start, start + block_size};
+    }
+};
+
+// Owned by exactly one thread (a shard worker): no atomics needed
+class IdRange {
+private:
+    BookingIdAllocator& allocator;
+    int next = 0, end = 0;
+
+public:
+    explicit IdRange(BookingIdAllocator& allocator) : allocator(allocator) {}
+
+    int next_id() {
+        if (next == end) tie(next, end) = allocator.claim_block();
+        return next++;
+    }
+};
+
+// ==========================================
+// BOOKING MANAGER (Controller / Facade)
+// ==========================================
+// A booking is two phases: HOLD the seats (armed on the timing wheel with a
+// configurable window), then CONFIRM with payment (timer cancelled). If the
+// user walks away, the wheel fires and the seats go back to AVAILABLE.
+struct SeatHold {
+    int hold_id;
+    string user;
+    Show* show;
+    vector<int> seats;
+    int timer_id;
+};
+
+class BookingManager {
+public:
+    using Clock = chrono::steady_clock;
+
+private:
+    atomic<int> next_booking_id{1000};
+    unique_ptr<IdRange> id_range;   // set when owned by a single shard thread
+    BookingJournal* journal = nullptr;
+    bool logging = true;
+
+    // Hold table + wheel share one short critical section (O(1) work inside)
+    mutex holds_mutex;
+    unordered_map<int, SeatHold> holds;
+    TimerWheel wheel;
+    int next_hold_id = 1;
+    Clock::time_point epoch = Clock::now();
+    chrono::milliseconds hold_window;
+    chrono::milliseconds tick;
+
+    // Background reaper that drives the wheel in real time
+    thread reaper;
+    condition_variable reaper_cv;
+    bool stopping = false;
+
+    uint64_t to_tick(Clock::time_point t) const {
+        if (t <= epoch) return 0;
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(t - epoch) / tick);
+    }
+
+    void print_seats(Show* show, const vector<int>& seats, const string& what) {
+        cout << "  " << what << " ";
+        for (int idx : seats) cout << show->seat_label(idx) << " ";
+        cout << "\n";
+    }
+
+public:
+    explicit BookingManager(chrono::milliseconds hold_window = chrono::minutes(5),
+                            chrono::milliseconds tick = chrono::milliseconds(100))
+        : hold_window(hold_window), tick(max(tick, chrono::milliseconds(1))) {}
+
+    ~BookingManager() { stop_expiry_thread(); }
+
+    void set_logging(bool on) { logging = on; }
+
+    // Confirmed bookings are returned only after they are durable
+    void set_journal(BookingJournal* j) { journal = j; }
+
+    // After replaying a journal: never reissue an id seen on disk
+    void resume_ids_after(int max_booking_id) {
+        int next = max_booking_id + 1;
+        int cur = next_booking_id.load();
+        while (cur < next && !next_booking_id.compare_exchange_weak(cur, next)) {}
+    }
+
+    // Only for a manager whose bookings all come from one thread (a shard)
+    void use_id_range(BookingIdAllocator& allocator) { id_range = make_unique<IdRange>(allocator); }
+
+    // Step 1 of a booking: hold ALL requested seats atomically and arm the
+    // hold's TTL. Returns the hold id, or -1 if any seat was taken.
+    int hold_seats(const string& user, Show* show, vector<int> seat_indices,
+                   Clock::time_point now = Clock::now()) {
+        if (logging) cout << "\n--- " << user << " attempting to book ---\n";
+        if (seat_indices.empty()) return -1;
+        if (static_cast<int>(seat_indices.size()) > MAX_SEATS_PER_BOOKING) {
+            if (logging) cout << "  ❌ At most " << MAX_SEATS_PER_BOOKING << " seats per booking.\n";
+            return -1;
+        }
+        // try_lock_all merges seats into word masks, where a repeated seat
+        // would collapse into one bit: reject bad requests before locking
+        vector<int> sorted = seat_indices;
+        sort(sorted.begin(), sorted.end());
+        if (sorted.front() < 0 || sorted.back() >= show->seat_map.size()) {
+            if (logging) cout << "  ❌ No such seat in this show.\n";
+            return -1;
+        }
+        if (adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            if (logging) cout << "  ❌ The same seat was requested twice.\n";
+            return -1;
+        }
+
+        int taken = show->seat_map.try_lock_all(seat_indices);
+        if (taken >= 0) {
+            if (logging) {
+                cout << "  ❌ Seat " << show->seat_label(taken) << " is already taken!\n";
+                cout << "  ⚠️ Booking failed! No seats were held.\n";
+            }
+            return -1;
+        }
+        if (logging) print_seats(show, seat_indices, "🔒 LOCKED:");
+        return arm_hold(user, show, move(seat_indices), now);
+    }
+
+    // Hold the best `party` seats available right now. Planning reads a
+    // snapshot, so a CAS conflict just means re-plan against fresh bitmaps.
+    int hold_best_available(const string& user, Show* show, int party,
+                            Clock::time_point now = Clock::now()) {
+        if (logging) cout << "\n--- " << user << " wants the best " << party << " seats ---\n";
+        if (party <= 0 || party > MAX_SEATS_PER_BOOKING) return -1;
+        SeatFinder finder(*show);
+        for (int attempt = 0; attempt < 16; ++attempt) {
+            bool split = false;
+            vector<int> seats = finder.find(party, &split);
+            if (seats.empty()) {
+                if (logging) cout << "  ❌ Not enough seats left for a party of " << party << ".\n";
+                return -1;
+            }
+            if (show->seat_map.try_lock_all(seats) >= 0) continue;   // lost the race: re-plan
+            if (logging) print_seats(show, seats, split ? "🔒 LOCKED (party split):" : "🔒 LOCKED:");
+            return arm_hold(user, show, move(seats), now);
+        }
+        return -1;
+    }
+
+    // Step 2: pay and confirm. Returns nullptr if the hold already expired,
+    // payment failed, or the journal could not make the booking durable
+    // (seats released; journal->error() says why). Same contract as the
+    // async path below.
+    Booking* confirm_hold(int hold_id, unique_ptr<IPaymentStrategy> payment) {
+        SeatHold hold;
+        if (!take_hold(hold_id, hold)) return nullptr;
+        return pay_and_confirm(hold.user, hold.show, move(hold.seats), move(payment));
+    }
+
+    // Async step 2: the hold leaves the TTL wheel, the gateway charges in the
+    // background, and `done` always runs on a gateway thread (never inline,
+    // even for an expired hold) with the Booking
+    // (caller owns it) or nullptr if payment failed, the hold had expired or
+    // the journal write failed.
+    // The booking id is reserved here, on the calling thread.
+    void confirm_hold_async(int hold_id, unique_ptr<IPaymentStrategy> payment,
+                            PaymentGateway& gateway, function<void(Booking*)> done) {
+        SeatHold hold;
+        if (!take_hold(hold_id, hold)) {
+            gateway.decline([done = move(done)](bool) { done(nullptr); });
+            return;
+        }
+        int total = 0;
+        for (int idx : hold.seats) total += hold.show->seat_price(idx);
+        // Allocated here so it comes from this thread's pool; PENDING until paid
+        Booking* booking = make_booking(allocate_booking_id(), hold.user, hold.show, hold.seats, total);
+        booking->status = BookingStatus::PENDING;
+        gateway.charge(move(payment), total, [booking, journal = journal, done = move(done)](bool ok) {
+            SeatMap& seat_map = booking->show->seat_map;
+            if (!ok) {
+                seat_map.release_all(booking->seat_indices);
+                delete booking;
+                done(nullptr);
+                return;
+            }
+            // Journal first: seats turn BOOKED only once the ticket is durable
+            try {
+                if (journal) journal->commit(*booking);
+            } catch (const exception&) {
+                seat_map.release_all(booking->seat_indices);
+                delete booking;
+                done(nullptr);
+                return;
+            }
+            seat_map.confirm_all(booking->seat_indices);
+            booking->status = BookingStatus::CONFIRMED;
+            done(booking);
+        });
+    }
+
+    future<Booking*> confirm_hold_async(int hold_id, unique_ptr<IPaymentStrategy> payment,
+                                        PaymentGateway& gateway) {
+        auto promise = make_shared<std::promise<Booking*>>();
+        future<Booking*> result = promise->get_future();
+        confirm_hold_async(hold_id, move(payment), gateway, [promise](Booking* b) { promise->set_value(b); });
+        return result;
+    }
+
+    // User backs out explicitly
+    bool release_hold(int hold_id) {
+        SeatHold hold;
+        if (!take_hold(hold_id, hold)) return false;
+        hold.show->seat_map.release_all(hold.seats);
+        return true;
+    }
+
+    // Advance the wheel to `now` and release every hold whose TTL passed
+    int expire_holds(Clock::time_point now = Clock::now()) {
+        vector<SeatHold> expired;
+        {
+            lock_guard<mutex> guard(holds_mutex);
+            wheel.advance(to_tick(now), [&](int hold_id) {
+                auto it = holds.find(hold_id);
+                if (it == holds.end()) return;
+                expired.push_back(move(it->second));
+                holds.erase(it);
+            });
+        }
+        for (const SeatHold& h : expired) {
+            h.show->seat_map.release_all(h.seats);
+            if (logging) {
+                cout << "  ⏰ Hold #" << h.hold_id << " (" << h.user << ") expired.";
+                print_seats(h.show, h.seats, "🔓 Released:");
+            }
+        }
+        return static_cast<int>(expired.size());
+    }
+
+    int active_holds() {
+        lock_guard<mutex> guard(holds_mutex);
+        return static_cast<int>(holds.size());
+    }
+
+    void start_expiry_thread() {
+        if (reaper.joinable()) return;
+        stopping = false;
+        reaper = thread([this] {
+            unique_lock<mutex> lk(holds_mutex);
+            while (!stopping) {
+                reaper_cv.wait_for(lk, tick);
+                if (stopping) break;
+                lk.unlock();
+                expire_holds();
+                lk.lock();
+            }
+        });
+    }
+
+    void stop_expiry_thread() {
+        {
+            lock_guard<mutex> guard(holds_mutex);
+            stopping = true;
+        }
+        reaper_cv.notify_all();
+        if (reaper.joinable()) reaper.join();
+    }
+
+    // One-shot booking: hold, then immediately pay and confirm
+    Booking* create_booking(const string& user, Show* show, 
+                            vector<int> seat_indices, 
+                            unique_ptr<IPaymentStrategy> payment) {
+        int hold_id = hold_seats(user, show, move(seat_indices));
+        if (hold_id < 0) return nullptr;
+        return confirm_hold(hold_id, move(payment));
+    }
+
+    Booking* book_best_available(const string& user, Show* show, int party,
+                                 unique_ptr<IPaymentStrategy> payment) {
+        int hold_id = hold_best_available(user, show, party);
+        if (hold_id < 0) return nullptr;
+        return confirm_hold(hold_id, move(payment));
+    }
+
+private:
+    // Removes a live hold from the table and cancels its TTL
+    bool take_hold(int hold_id, SeatHold& out) {
+        lock_guard<mutex> guard(holds_mutex);
+        auto it = holds.find(hold_id);
+        if (it == holds.end()) {
+            if (logging) cout << "  ⌛ Hold #" << hold_id << " has expired. Please select seats again.\n";
+            return false;
+        }
+        wheel.cancel(it->second.timer_id);
+        out = move(it->second);
+        holds.erase(it);
+        return true;
+    }
+
+    int allocate_booking_id() {
+        return id_range ? id_range->next_id() : next_booking_id.fetch_add(1, memory_order_relaxed);
+    }
+
+    static Booking* make_booking(int booking_id, const string& user, Show* show, const vector<int>& seats, int total) {
+        Booking* booking = new Booking();
+        booking->booking_id = booking_id;
+        booking->user_name = user;
+        booking->show = show;
+        booking->seat_indices = SeatList(seats);
+        booking->total_price = total;
+        booking->status = BookingStatus::CONFIRMED;
+        return booking;
+    }
+
+    int arm_hold(const string& user, Show* show, vector<int> seats, Clock::time_point now) {
+        lock_guard<mutex> guard(holds_mutex);
+        int hold_id = next_hold_id++;
+        int timer_id = wheel.arm_at(to_tick(now + hold_window), hold_id);
+        holds.emplace(hold_id, SeatHold{hold_id, user, show, move(seats), timer_id});
+        return hold_id;
+    }
+
+    Booking* pay_and_confirm(const string& user, Show* show, vector<int> seat_indices,
+                             unique_ptr<IPaymentStrategy> payment) {
+
+        // Step 2: Calculate total price
+        int total = 0;
+        for (int idx : seat_indices) total += show->seat_price(idx);
+
+        // Step 3: Process payment
+        if (logging) cout << "  Processing payment of $" << total << "...\n";
+        if (!payment->pay(total)) {
+            if (logging) cout << "  ⚠️ Payment FAILED! Releasing seats.\n";
+            show->seat_map.release_all(seat_indices);
+            return nullptr;
+        }
+
+        // Step 4: Journal, then confirm. Seats stay LOCKED until the record is
+        // durable, so a failed commit can hand them back.
+        Booking* booking = make_booking(allocate_booking_id(), user, show, seat_indices, total);
+        if (journal) {
+            try {
+                journal->commit(*booking);
+            } catch (const exception& e) {
+                if (logging) cout << "  ⚠️ Journal write FAILED (" << e.what() << ")! Releasing seats.\n";
+                show->seat_map.release_all(seat_indices);
+                delete booking;
+                return nullptr;
+            }
+        }
+        show->seat_map.confirm_all(seat_indices);
+        if (logging) print_seats(show, seat_indices, "✅ BOOKED:");
+        return booking;
+    }
+};
+
+// ==========================================
+// HOLD EXPIRY DEMO + WHEEL BENCHMARK
+// ==========================================
+void hold_expiry_demo(Show& show) {
+    cout << "\n--- Seat holds with a 5-minute window ---\n";
+    BookingManager manager(chrono::minutes(5));
+    auto now = BookingManager::Clock::now();
+
+    // Dave holds B1, B2 and walks away without paying
+    int dave = manager.hold_seats("Dave", &show, {5, 6}, now);
+    // Erin holds B3 and pays after 2 minutes
+    int erin = manager.hold_seats("Erin", &show, {7}, now);
+    Booking* b = manager.confirm_hold(erin, make_unique<UPIPayment>());
+
+    cout << "  ... 5 minutes later ...\n";
+    manager.expire_holds(now + chrono::minutes(5) + chrono::seconds(1));
+    Booking* late = manager.confirm_hold(dave, make_unique<CreditCardPayment>());
+    if (!late) cout << "  Dave's late payment was refused; card NOT charged.\n";
+    show.display_seats();
+    delete b;
+
+    // Real-time expiry: background reaper drives the wheel
+    BookingManager quick(chrono::milliseconds(200), chrono::milliseconds(20));
+    quick.set_logging(false);
+    quick.start_expiry_thread();
+    quick.hold_seats("Frank", &show, {8, 9});
+    cout << "  Frank holds B4, B5 (200 ms window): " << show.seat_map.count(SeatStatus::LOCKED) << " seats locked\n";
+    this_thread::sleep_for(chrono::milliseconds(350));
+    cout << "  After 350 ms: " << show.seat_map.count(SeatStatus::LOCKED)
+         << " seats locked, " << quick.active_holds() << " active holds\n";
+    quick.stop_expiry_thread();
+}
+
+void timer_wheel_benchmark() {
+    const int n = 200000;
+    TimerWheel wheel;
+    mt19937 rng(42);
+    uniform_int_distribution<int> ttl(1, 3000);    // 100 ms ticks → up to 5 minutes
+    vector<int> ids(n);
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) ids[i] = wheel.arm_at(wheel.now() + ttl(rng), i);
+    double arm_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / n;
+
+    // 90% of users pay in time → their timers are cancelled
+    start = chrono::steady_clock::now();
+    int cancelled = 0;
+    for (int i = 0; i < n; ++i) if (i % 10 != 0) cancelled += wheel.cancel(ids[i]);
+    double cancel_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / cancelled;
+
+    start = chrono::steady_clock::now();
+    int fired = 0;
+    wheel.advance(3001, [&](int) { ++fired; });
+    double advance_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "\n--- Timer wheel: " << n << " holds ---\n";
+    cout << "  arm " << fixed << setprecision(1) << arm_ns << " ns/op, cancel " << cancel_ns
+         << " ns/op, " << fired << " expiries fired over 3000 ticks in " << advance_ms << " ms\n";
+}
+
+// Silent payment used by benchmarks (no console I/O per booking)
+class NoOpPayment : public IPaymentStrategy {
+public:
+    bool pay(int) override { return true; }
+};
+
+// ==========================================
+// STADIUM DEMO (5,000 seats, many threads)
+// ==========================================
+void stadium_demo() {
+    const int rows = 50, cols = 100, threads = 4, attempts = 2000;
+    vector<RowInfo> layout;
+    for (int r = 0; r < rows; ++r) layout.push_back({r < 5 ? SeatType::VIP : SeatType::REGULAR, r < 5 ? 25 : 12});
+    Show stadium({"World Cup Final (Live)", "Sports", 120}, "8:00 PM", "Stadium", layout, cols);
+
+    BookingManager manager;
+    manager.set_logging(false);
+    atomic<int> booked{0}, rejected{0};
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> fans;
+    for (int t = 0; t < threads; ++t) {
+        fans.emplace_back([&, t] {
+            mt19937 rng(t);
+            uniform_int_distribution<int> any_seat(0, rows * cols - 2);
+            for (int i = 0; i < attempts; ++i) {
+                int s = any_seat(rng);
+                Booking* b = manager.create_booking("fan", &stadium, {s, s + 1}, make_unique<NoOpPayment>());
+                if (b) { booked++; delete b; } else rejected++;
+            }
+        });
+    }
+    for (auto& f : fans) f.join();
+    double book_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    int available = stadium.seat_map.count(SeatStatus::AVAILABLE);
+    double scan_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    cout << "\n--- Stadium: " << rows * cols << " seats, " << threads << " threads ---\n";
+    cout << "  Seat state: " << stadium.seat_map.bytes() << " bytes in "
+         << stadium.seat_map.word_count() << " atomic words (vs one heap Seat + mutex per seat)\n";
+    cout << "  Pair bookings: " << booked << " ok, " << rejected << " rejected in "
+         << fixed << setprecision(1) << book_ms << " ms\n";
+    cout << "  Availability scan: " << available << " seats free, " << scan_us << " us"
+         << " (incremental counter: " << stadium.seat_map.available() << ")\n";
+}
+
+// ==========================================
+// GROUP HOLD BENCHMARK (seat-by-seat vs word CAS)
+// ==========================================
+// Seat-by-seat locking leaves a window where a group is half-held: a rival
+// group hits those seats, fails, and rolls back work that never needed doing.
+void group_hold_benchmark() {
+    const int rows = 20, cols = 30, threads = 4, attempts = 20000, group = 4;
+
+    auto run = [&](const string& name, bool word_cas) {
+        SeatMap map(rows, cols);
+        atomic<long> held{0}, failed{0}, rolled_back{0};
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                mt19937 rng(t * 7 + 1);
+                uniform_int_distribution<int> pick_row(0, rows - 1), pick_col(0, cols - group);
+                vector<int> seats(group);
+                for (int i = 0; i < attempts; ++i) {
+                    int base = pick_row(rng) * cols + pick_col(rng);
+                    for (int k = 0; k < group; ++k) seats[k] = base + k;
+                    bool ok = true;
+                    if (word_cas) {
+                        ok = map.try_lock_all(seats) < 0;
+                    } else {
+                        for (int k = 0; k < group && ok; ++k) {
+                            if (!map.try_lock(seats[k])) {
+                                ok = false;
+                                for (int u = 0; u < k; ++u) map.release(seats[u]);
+                                rolled_back += k;
+                            }
+                        }
+                    }
+                    if (!ok) { failed++; continue; }
+                    held++;
+                    // Payment window, then give the seats back for the next fan
+                    this_thread::yield();
+                    if (word_cas) map.release_all(seats);
+                    else for (int s : seats) map.release(s);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "  " << left << setw(16) << name << right
+             << " holds " << setw(6) << held << "  conflicts " << setw(6) << failed
+             << "  seats rolled back " << setw(6) << rolled_back
+             << "  " << fixed << setprecision(1) << setw(7) << ms << " ms\n";
+    };
+
+    cout << "\n--- Group hold: " << threads << " threads x " << attempts
+         << " holds of " << group << " adjacent seats ---\n";
+    run("seat-by-seat", false);
+    run("word CAS", true);
+}
+
+// ==========================================
+// BEST AVAILABLE DEMO + FINDER BENCHMARK
+// ==========================================
+void best_available_demo() {
+    vector<RowInfo> layout(8, {SeatType::REGULAR, 10});
+    Show show({"Dune: Part Two", "Sci-Fi", 166}, "9:30 PM", "IMAX", layout, 12);
+    BookingManager manager;
+
+    // Pre-fill a scattered audience so the centre is partly taken
+    manager.set_logging(false);
+    mt19937 rng(7);
+    uniform_int_distribution<int> any(0, 8 * 12 - 1);
+    for (int i = 0; i < 50; ++i) delete manager.create_booking("walk-in", &show, {any(rng)}, make_unique<NoOpPayment>());
+    manager.set_logging(true);
+    show.display_seats();
+
+    for (int party : {4, 6, 10}) {
+        Booking* b = manager.book_best_available("Group", &show, party, make_unique<NoOpPayment>());
+        delete b;
+    }
+    show.display_seats();
+
+    // Finder cost on a 5,000-seat stadium that is ~70% sold
+    vector<RowInfo> big(50, {SeatType::REGULAR, 12});
+    Show stadium({"Stadium Show", "Live", 120}, "8:00 PM", "Stadium", big, 100);
+    uniform_int_distribution<int> seat(0, 50 * 100 - 1);
+    for (int i = 0; i < 3500; ++i) stadium.seat_map.try_lock(seat(rng));
+    SeatFinder finder(stadium);
+    const int iters = 2000;
+    auto start = chrono::steady_clock::now();
+    size_t found = 0;
+    for (int i = 0; i < iters; ++i) found += finder.find(4).size();
+    double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / iters;
+    cout << "\n--- Best-available finder: 5000 seats, 70% sold, party of 4 ---\n";
+    cout << "  " << fixed << setprecision(2) << us << " us per search (" << found / iters << " seats proposed)\n";
+}
+
+// ==========================================
+// FLASH SALE ADMISSION QUEUE
+// ==========================================
+// When 100K fans hit "Book" in the same second, letting every request race
+// into the seat map just burns CPU on conflicts. Instead each show has a
+// waiting room: a bounded lock-free MPMC ring (Vyukov). Clients get a queue
+// position immediately; a fixed set of workers drain it at the rate the
+// booking path can sustain. A full ring is explicit backpressure: "busy,
+// retry" instead of unbounded memory growth.
+template <typename T>
+class BoundedMpmcQueue {
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T data;
+    };
+    vector<Cell> buffer;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueue_pos{0};
+    alignas(64) atomic<size_t> dequeue_pos{0};
+
+public:
+    explicit BoundedMpmcQueue(size_t capacity_pow2)
+        : buffer(capacity_pow2), mask(capacity_pow2 - 1) {
+        for (size_t i = 0; i < capacity_pow2; ++i) buffer[i].sequence.store(i, memory_order_relaxed);
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t pushed() const { return enqueue_pos.load(memory_order_relaxed); }
+    size_t popped() const { return dequeue_pos.load(memory_order_relaxed); }
+
+    // On success `ticket` is the global arrival number (queue position)
+    bool try_push(const T& value, size_t& ticket) {
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+        cell->data = value;
+        cell->sequence.store(pos + 1, memory_order_release);
+        ticket = pos;
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = dequeue_pos.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;   // empty
+            } else {
+                pos = dequeue_pos.load(memory_order_relaxed);
+            }
+        }
+        out = cell->data;
+        cell->sequence.store(pos + mask + 1, memory_order_release);
+        return true;
+    }
+};
+
+struct AdmissionRequest {
+    int client_id;
+    int first_seat;      // -1 = best available
+    int party_size;
+};
+
+enum class AdmissionStatus { QUEUED, BUSY, SOLD_OUT };
+
+struct AdmissionTicket {
+    AdmissionStatus status;
+    size_t ticket = 0;        // arrival number, valid when QUEUED
+    size_t people_ahead = 0;  // position feedback shown to the fan
+};
+
+class AdmissionQueue {
+private:
+    Show* show;
+    BookingManager& manager;
+    BoundedMpmcQueue<AdmissionRequest> queue;
+    function<void(int client_id, bool booked)> on_result;
+    vector<thread> workers;
+    atomic<bool> closed{false};     // no new entries (sold out)
+    atomic<bool> stopping{false};
+
+    void worker_loop() {
+        AdmissionRequest req;
+        while (true) {
+            if (!queue.try_pop(req)) {
+                if (stopping.load(memory_order_acquire)) return;
+                this_thread::yield();
+                continue;
+            }
+            Booking* b = nullptr;
+            if (closed.load(memory_order_relaxed)) {
+                // sold out while this fan was waiting
+            } else if (req.first_seat < 0) {
+                b = manager.book_best_available("fan", show, req.party_size, make_unique<NoOpPayment>());
+            } else {
+                vector<int> seats;
+                for (int k = 0; k < req.party_size; ++k) seats.push_back(req.first_seat + k);
+                b = manager.create_booking("fan", show, move(seats), make_unique<NoOpPayment>());
+            }
+            if (!b && !closed.load(memory_order_relaxed) && show->seat_map.available() == 0)
+                closed.store(true, memory_order_relaxed);
+            if (on_result) on_result(req.client_id, b != nullptr);
+            delete b;
+        }
+    }
+
+public:
+    AdmissionQueue(Show* show, BookingManager& manager, size_t capacity_pow2,
+                   function<void(int, bool)> on_result)
+        : show(show), manager(manager), queue(capacity_pow2), on_result(move(on_result)) {}
+
+    ~AdmissionQueue() { stop(); }
+
+    void start(int num_workers) {
+        for (int i = 0; i < num_workers; ++i) workers.emplace_back([this] { worker_loop(); });
+    }
+
+    // Drain what is queued, then stop the workers
+    void stop() {
+        stopping.store(true, memory_order_release);
+        for (auto& w : workers) w.join();
+        workers.clear();
+    }
+
+    AdmissionTicket submit(const AdmissionRequest& req) {
+        if (closed.load(memory_order_relaxed)) return {AdmissionStatus::SOLD_OUT};
+        size_t ticket;
+        if (!queue.try_push(req, ticket)) return {AdmissionStatus::BUSY};
+        return {AdmissionStatus::QUEUED, ticket, people_ahead(ticket)};
+    }
+
+    size_t people_ahead(size_t ticket) const {
+        size_t served = queue.popped();
+        return ticket > served ? ticket - served : 0;
+    }
+
+    bool sold_out() const { return closed.load(memory_order_relaxed); }
+};
+
+void flash_sale_benchmark() {
+    const int rows = 50, cols = 100, clients = 100000, producers = 8, max_retries = 50;
+    vector<RowInfo> layout(rows, {SeatType::REGULAR, 12});
+    Show show({"Eras Tour (Live)", "Concert", 200}, "7:00 PM", "Stadium", layout, cols);
+    BookingManager manager;
+    manager.set_logging(false);
+
+    atomic<int> booked{0}, lost_race{0};
+    AdmissionQueue admission(&show, manager, 4096, [&](int, bool ok) { (ok ? booked : lost_race)++; });
+    admission.start(2);
+
+    atomic<long> queued{0}, busy_retries{0}, gave_up{0}, sold_out{0}, max_ahead{0};
+    auto start = chrono::steady_clock::now();
+    vector<thread> fans;
+    for (int p = 0; p < producers; ++p) {
+        fans.emplace_back([&, p] {
+            mt19937 rng(p + 100);
+            uniform_int_distribution<int> pick_row(0, rows - 1), pick_col(0, cols - 4), party(1, 4);
+            for (int c = p; c < clients; c += producers) {
+                int size = party(rng);
+                // Half the fans pick exact seats, half ask for "best available"
+                int first = (c % 2) ? pick_row(rng) * cols + pick_col(rng) : -1;
+                AdmissionRequest req{c, first, size};
+                int attempt = 0;
+                while (true) {
+                    AdmissionTicket t = admission.submit(req);
+                    if (t.status == AdmissionStatus::QUEUED) {
+                        queued++;
+                        long ahead = static_cast<long>(t.people_ahead);
+                        long prev = max_ahead.load(memory_order_relaxed);
+                        while (ahead > prev && !max_ahead.compare_exchange_weak(prev, ahead)) {}
+                        break;
+                    }
+                    if (t.status == AdmissionStatus::SOLD_OUT) { sold_out++; break; }
+                    if (++attempt > max_retries) { gave_up++; break; }
+                    busy_retries++;
+                    this_thread::yield();   // client-side backoff
+                }
+            }
+        });
+    }
+    for (auto& f : fans) f.join();
+    admission.stop();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "\n--- Flash sale: " << clients << " clients, " << rows * cols
+         << " seats, queue capacity 4096, 2 workers ---\n";
+    cout << "  queued " << queued << ", sold-out fast rejects " << sold_out
+         << ", gave up after retries " << gave_up << ", busy retries " << busy_retries << "\n";
+    cout << "  booked " << booked << ", lost seat race " << lost_race
+         << ", seats left " << show.seat_map.count(SeatStatus::AVAILABLE)
+         << " (counter " << show.seat_map.available() << ")"
+         << ", max people ahead " << max_ahead << "\n";
+    cout << "  " << fixed << setprecision(1) << ms << " ms ("
+         << setprecision(0) << clients / (ms / 1000.0) << " clients/s)\n";
+}
+
+// ==========================================
+// SHARDED BOOKING SERVICE (partitioned by show)
+// ==========================================
+// One BookingManager for the whole country means every booking funnels
+// through the same hold table mutex and the same id counter. Shows never
+// share seats, so partition by show: each shard owns a BookingManager, an
+// id range and ONE worker thread. All bookings for a show execute on its
+// shard, serially, with no cross-shard locks at all.
+struct ShardJob {
+    Show* show = nullptr;
+    int party = 0;
+    function<void(Booking*)> done;
+};
+
+// Bookings handed out by a shard come from its BookingPool, whose arena
+// outlives the shard while any of them is alive, so callers may keep a
+// Booking past the BookingService. Async confirmations still in the
+// gateway touch the show's seat map, so the destructor waits for those.
+class BookingShard {
+private:
+    BookingManager manager;
+    PaymentGateway* gateway;        // null = pay inline on the shard thread
+    BoundedMpmcQueue<ShardJob> inbox;
+    BookingPool pool{sizeof(Booking)};
+    thread worker;
+    atomic<bool> stopping{false};
+    atomic<long> processed{0};
+    mutex confirm_mtx;
+    condition_variable confirm_cv;
+    long confirming = 0;            // async confirmations awaiting the gateway
+
+    void run() {
+        pool.bind_to_current_thread();
+        ShardJob job;
+        int idle = 0;
+        while (true) {
+            if (!inbox.try_pop(job)) {
+                if (stopping.load(memory_order_acquire)) return;
+                if (++idle < 64) this_thread::yield();
+                else this_thread::sleep_for(chrono::microseconds(50));
+                continue;
+            }
+            idle = 0;
+            processed.fetch_add(1, memory_order_relaxed);
+            auto done = job.done ? job.done : [](Booking* b) { delete b; };
+            if (gateway) {
+                // Hold on the shard thread, pay off it: the shard moves on at once
+                int hold_id = manager.hold_best_available("fan", job.show, job.party);
+                if (hold_id < 0) {
+                    gateway->decline([done = move(done)](bool) { done(nullptr); });
+                    continue;
+                }
+                {
+                    lock_guard<mutex> guard(confirm_mtx);
+                    ++confirming;
+                }
+                manager.confirm_hold_async(hold_id, make_unique<NoOpPayment>(), *gateway,
+                                           [this, done = move(done)](Booking* b) {
+                    done(b);
+                    // Last touch of the shard: it may be destroyed right after
+                    lock_guard<mutex> guard(confirm_mtx);
+                    if (--confirming == 0) confirm_cv.notify_all();
+                });
+            } else {
+                done(manager.book_best_available("fan", job.show, job.party, make_unique<NoOpPayment>()));
+            }
+        }
+    }
+
+public:
+    BookingShard(BookingIdAllocator& ids, size_t inbox_capacity, PaymentGateway* gateway = nullptr)
+        : gateway(gateway), inbox(inbox_capacity) {
+        manager.set_logging(false);
+        manager.use_id_range(ids);
+        worker = thread([this] { run(); });
+    }
+
+    ~BookingShard() {
+        stopping.store(true, memory_order_release);
+        worker.join();
+        unique_lock<mutex> lk(confirm_mtx);
+        confirm_cv.wait(lk, [&] { return confirming == 0; });
+    }
+
+    bool submit(ShardJob job) {
+        size_t ticket;
+        return inbox.try_push(job, ticket);
+    }
+
+    long jobs_processed() const { return processed.load(memory_order_relaxed); }
+};
+
+// Shows are owned and numbered elsewhere (a ShowCatalog): the journal
+// records show_id, so the service routes by that id and never renumbers.
+// Registered shows must outlive the service.
+class BookingService {
+private:
+    BookingIdAllocator ids;
+    vector<Show*> shows;
+    vector<unique_ptr<BookingShard>> shards;
+
+public:
+    // With a gateway, `done` callbacks run on gateway threads instead
+    explicit BookingService(int num_shards, size_t inbox_capacity = 4096, PaymentGateway* gateway = nullptr) {
+        for (int i = 0; i < num_shards; ++i)
+            shards.push_back(make_unique<BookingShard>(ids, inbox_capacity, gateway));
+    }
+
+    // Shows are registered up front (admin flow), before bookings start
+    Show* add_show(Show* show) {
+        if (show->show_id <= 0) throw invalid_argument("BookingService::add_show: show has no show_id");
+        shows.push_back(show);
+        return show;
+    }
+
+    int shard_of(const Show* show) const { return show->show_id % static_cast<int>(shards.size()); }
+
+    // Async: `done` runs on the show's shard thread and owns the Booking.
+    // Returns false when that shard's inbox is full (backpressure).
+    bool book_best_available(Show* show, int party, function<void(Booking*)> done) {
+        return shards[shard_of(show)]->submit({show, party, move(done)});
+    }
+
+    int shard_count() const { return static_cast<int>(shards.size()); }
+    const vector<Show*>& all_shows() const { return shows; }
+};
+
+void sharded_service_benchmark() {
+    const int num_shows = 8, producers = 4, requests = 40000;
+    // Stand-in for a catalog: owns the shows and numbers them 1..num_shows
+    auto make_show = [](int i) {
+        vector<RowInfo> layout(20, {SeatType::REGULAR, 10});
+        auto show = make_unique<Show>(Movie{"Movie " + to_string(i), "Drama", 120}, "6:00 PM",
+                                      "Screen " + to_string(i), layout, 100);
+        show->show_id = i + 1;
+        return show;
+    };
+    auto report = [&](const string& name, double ms, long booked, const vector<unique_ptr<Show>>& shows) {
+        int sold = 0;
+        for (auto& s : shows) sold += s->seat_map.count(SeatStatus::BOOKED);
+        cout << "  " << left << setw(22) << name << right << fixed << setprecision(1) << setw(7) << ms
+             << " ms  bookings " << setw(6) << booked << "  seats sold " << sold << "\n";
+    };
+    cout << "\n--- " << requests << " best-available requests over " << num_shows << " shows, "
+         << producers << " client threads ---\n";
+
+    // Baseline: one shared BookingManager, clients call it directly
+    {
+        vector<unique_ptr<Show>> shows;
+        for (int i = 0; i < num_shows; ++i) shows.push_back(make_show(i));
+        BookingManager manager;
+        manager.set_logging(false);
+        atomic<long> booked{0};
+        auto start = chrono::steady_clock::now();
+        vector<thread> clients;
+        for (int p = 0; p < producers; ++p) {
+            clients.emplace_back([&, p] {
+                for (int r = p; r < requests; r += producers) {
+                    Booking* b = manager.book_best_available("fan", shows[r % num_shows].get(), 1 + r % 4,
+                                                             make_unique<NoOpPayment>());
+                    if (b) { booked++; delete b; }
+                }
+            });
+        }
+        for (auto& c : clients) c.join();
+        report("single manager", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(),
+               booked, shows);
+    }
+
+    // Sharded: clients enqueue, each shard thread owns its shows
+    {
+        atomic<long> booked{0}, completed{0}, busy{0};
+        vector<unique_ptr<Show>> shows;
+        for (int i = 0; i < num_shows; ++i) shows.push_back(make_show(i));
+        {
+            BookingService service(4);
+            for (auto& show : shows) service.add_show(show.get());
+            auto done = [&](Booking* b) {
+                if (b) { booked++; delete b; }
+                completed.fetch_add(1, memory_order_release);
+            };
+            auto start = chrono::steady_clock::now();
+            vector<thread> clients;
+            for (int p = 0; p < producers; ++p) {
+                clients.emplace_back([&, p] {
+                    for (int r = p; r < requests; r += producers) {
+                        Show* show = service.all_shows()[r % num_shows];
+                        while (!service.book_best_available(show, 1 + r % 4, done)) { busy++; this_thread::yield(); }
+                    }
+                });
+            }
+            for (auto& c : clients) c.join();
+            while (completed.load(memory_order_acquire) < requests) this_thread::yield();
+            report("sharded (4 shards)", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(),
+                   booked, shows);
+        }
+        cout << "  (sharded inbox-full retries: " << busy << ")\n";
+    }
+}
+
+// ==========================================
+// BOOKING ALLOCATION BENCHMARK (heap vs pool)
+// ==========================================
+void booking_pool_benchmark() {
+    const int iterations = 500000, live = 64;
+    Show* show = nullptr;
+    vector<int> seats = {10, 11, 12, 13};
+
+    // Baseline: what every booking used to cost (object + seat vector)
+    struct HeapBooking {
+        int booking_id;
+        string user_name;
+        Show* show;
+        vector<int> seat_indices;
+        int total_price;
+    };
+    vector<HeapBooking*> ring_heap(live, nullptr);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        HeapBooking*& slot = ring_heap[i % live];
+        delete slot;
+        slot = new HeapBooking{i, "fan", show, seats, 40};
+    }
+    for (auto* b : ring_heap) delete b;
+    double heap_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+
+    BookingPool pool(sizeof(Booking));
+    pool.bind_to_current_thread();
+    vector<Booking*> ring_pool(live, nullptr);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        Booking*& slot = ring_pool[i % live];
+        delete slot;
+        slot = new Booking();
+        slot->booking_id = i;
+        slot->user_name = "fan";
+        slot->show = show;
+        slot->seat_indices = SeatList(seats);
+        slot->total_price = 40;
+    }
+    for (auto* b : ring_pool) delete b;
+    double pool_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+    BookingPool::unbind_current_thread();
+
+    cout << "\n--- Booking allocation: " << iterations << " create/delete, " << live << " live ---\n";
+    cout << "  heap object + seat vector : " << fixed << setprecision(1) << heap_ns << " ns/booking (2 allocations)\n";
+    cout << "  pooled, inline seats      : " << pool_ns << " ns/booking (" << pool.chunk_count()
+         << " chunk of " << BookingPool::CHUNK_SLOTS << " slots, sizeof(Booking) = " << sizeof(Booking) << ")\n";
+}
+
+// ==========================================
+// ASYNC PAYMENT DEMO (sync vs pipelined)
+// ==========================================
+// Fake payment strategy that blocks like a gateway round-trip
+class SlowPayment : public IPaymentStrategy {
+    chrono::microseconds latency;
+public:
+    explicit SlowPayment(chrono::microseconds latency) : latency(latency) {}
+    bool pay(int) override { this_thread::sleep_for(latency); return true; }
+};
+
+void async_payment_benchmark() {
+    const int requests = 400, connections = 32;
+    const auto latency = chrono::milliseconds(2);
+    auto make_show = [] {
+        vector<RowInfo> layout(20, {SeatType::REGULAR, 10});
+        return make_unique<Show>(Movie{"Oppenheimer", "Drama", 180}, "6:00 PM", "Screen 1", layout, 100);
+    };
+    cout << "\n--- Payment: " << requests << " bookings on one shard, gateway latency "
+         << latency.count() << " ms ---\n";
+
+    // Future-based single booking, for illustration
+    {
+        PaymentGateway gateway(1, latency);
+        BookingManager manager;
+        manager.set_logging(false);
+        auto show = make_show();
+        int hold = manager.hold_best_available("Grace", show.get(), 2);
+        future<Booking*> pending = manager.confirm_hold_async(hold, make_unique<NoOpPayment>(), gateway);
+        cout << "  Grace's seats are held while the gateway runs; status: "
+             << (show->seat_map.count(SeatStatus::LOCKED) == 2 ? "LOCKED" : "?") << "\n";
+        Booking* b = pending.get();
+        cout << "  future resolved: booking #" << (b ? b->booking_id : -1)
+             << ", seats now " << (show->seat_map.count(SeatStatus::BOOKED) == 2 ? "BOOKED" : "?") << "\n";
+        delete b;
+    }
+
+    auto report = [](const string& name, double ms, long booked) {
+        cout << "  " << left << setw(26) << name << right << fixed << setprecision(1) << setw(8) << ms
+             << " ms  " << setw(4) << booked << " booked  "
+             << setprecision(0) << setw(7) << booked / (ms / 1000.0) << " bookings/s\n";
+    };
+
+    // Inline: one booking thread, each pay() blocks for the round-trip
+    {
+        BookingManager manager;
+        manager.set_logging(false);
+        auto show = make_show();
+        long booked = 0;
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < requests; ++r) {
+            Booking* b = manager.book_best_available("fan", show.get(), 2, make_unique<SlowPayment>(latency));
+            if (b) { booked++; delete b; }
+        }
+        report("inline payment", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(), booked);
+    }
+
+    // Pipelined: the shard holds seats and hands payment to the gateway
+    {
+        PaymentGateway gateway(connections, latency);
+        atomic<long> booked{0}, completed{0};
+        auto start = chrono::steady_clock::now();
+        auto owned = make_show();
+        owned->show_id = 1;
+        BookingService service(1, 1024, &gateway);
+        Show* show = service.add_show(owned.get());
+        auto done = [&](Booking* b) {
+            if (b) { booked++; delete b; }
+            completed.fetch_add(1, memory_order_release);
+        };
+        for (int r = 0; r < requests; ++r)
+            while (!service.book_best_available(show, 2, done)) this_thread::yield();
+        while (completed.load(memory_order_acquire) < requests) this_thread::yield();
+        report("async gateway (32 conns)", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(),
+               booked);
+    }
+}
+
+// ==========================================
+// SHOW CATALOG (browse + availability index)
+// ==========================================
+// "All shows of movie X in city Y with >= N seats free" should not walk every
+// show, let alone every seat. Names are interned to dense ids once, at
+// registration; each index is a flat vector (or ordered map for time
+// ranges) of show ids; availability is SeatMap::available(), a counter the
+// booking path already keeps up to date.
+struct CinemaHall {
+    int hall_id;
+    string name;
+    int city_id;
+};
+
+// "7:00 PM" → minutes since midnight (1140); -1 unless the slot is
+// "H:MM AM" / "HH:MM PM" (hour 1-12)
+int slot_minutes(const string& slot) {
+    size_t colon = slot.find(':');
+    if (colon == string::npos || colon == 0 || colon > 2 || slot.size() != colon + 6) return -1;
+    auto digit = [&](size_t i) { return isdigit(static_cast<unsigned char>(slot[i])) != 0; };
+    for (size_t i = 0; i < colon; ++i) if (!digit(i)) return -1;
+    if (!digit(colon + 1) || !digit(colon + 2) || slot[colon + 3] != ' ') return -1;
+    string suffix = slot.substr(colon + 4);
+    if (suffix != "AM" && suffix != "PM") return -1;
+    int h = stoi(slot.substr(0, colon)), m = stoi(slot.substr(colon + 1, 2));
+    if (h < 1 || h > 12 || m > 59) return -1;
+    if (h == 12) h = 0;
+    return (h + (suffix == "PM" ? 12 : 0)) * 60 + m;
+}
+
+class ShowCatalog {
+private:
+    vector<Movie> movies;
+    unordered_map<string, int> movie_ids;
+    vector<string> cities;
+    unordered_map<string, int> city_ids;
+    vector<CinemaHall> halls;
+    vector<unique_ptr<Show>> shows;            // show_id - 1 → Show
+
+    vector<vector<int>> by_movie;              // movie_id → show ids
+    vector<vector<int>> by_hall;               // hall_id → show ids
+    unordered_map<uint64_t, vector<int>> by_movie_city;
+    map<int, vector<int>> by_start;            // minutes since midnight → show ids
+
+    static uint64_t movie_city_key(int movie_id, int city_id) {
+        return (static_cast<uint64_t>(movie_id) << 32) | static_cast<uint32_t>(city_id);
+    }
+
+    int intern_city(const string& city) {
+        auto it = city_ids.find(city);
+        if (it != city_ids.end()) return it->second;
+        cities.push_back(city);
+        return city_ids[city] = static_cast<int>(cities.size()) - 1;
+    }
+
+    template <typename Pred>
+    vector<Show*> collect(const vector<int>& ids, Pred keep) const {
+        vector<Show*> out;
+        for (int id : ids) {
+            Show* s = shows[id - 1].get();
+            if (keep(s)) out.push_back(s);
+        }
+        return out;
+    }
+
+public:
+    int add_movie(const Movie& movie) {
+        auto it = movie_ids.find(movie.title);
+        if (it != movie_ids.end()) return it->second;
+        movies.push_back(movie);
+        by_movie.emplace_back();
+        return movie_ids[movie.title] = static_cast<int>(movies.size()) - 1;
+    }
+
+    int add_hall(const string& name, const string& city) {
+        int hall_id = static_cast<int>(halls.size());
+        halls.push_back({hall_id, name, intern_city(city)});
+        by_hall.emplace_back();
+        return hall_id;
+    }
+
+    // Throws invalid_argument for a slot slot_minutes() cannot read
+    Show* add_show(int movie_id, int hall_id, const string& slot, vector<RowInfo> layout, int cols) {
+        int start = slot_minutes(slot);
+        if (start < 0) throw invalid_argument("ShowCatalog::add_show: bad time slot \"" + slot + "\"");
+        shows.push_back(make_unique<Show>(movies[movie_id], slot, halls[hall_id].name, move(layout), cols));
+        Show* show = shows.back().get();
+        show->show_id = static_cast<int>(shows.size());
+        show->hall_id = hall_id;
+        by_movie[movie_id].push_back(show->show_id);
+        by_hall[hall_id].push_back(show->show_id);
+        by_movie_city[movie_city_key(movie_id, halls[hall_id].city_id)].push_back(show->show_id);
+        by_start[start].push_back(show->show_id);
+        return show;
+    }
+
+    // The headline query: one hash lookup + one counter load per candidate
+    vector<Show*> find_shows(const string& movie_title, const string& city, int min_free) const {
+        auto m = movie_ids.find(movie_title);
+        auto c = city_ids.find(city);
+        if (m == movie_ids.end() || c == city_ids.end()) return {};
+        auto it = by_movie_city.find(movie_city_key(m->second, c->second));
+        if (it == by_movie_city.end()) return {};
+        return collect(it->second, [&](Show* s) { return s->seat_map.available() >= min_free; });
+    }
+
+    vector<Show*> shows_for_movie(const string& movie_title) const {
+        auto m = movie_ids.find(movie_title);
+        if (m == movie_ids.end()) return {};
+        return collect(by_movie[m->second], [](Show*) { return true; });
+    }
+
+    vector<Show*> shows_in_hall(int hall_id) const {
+        return collect(by_hall[hall_id], [](Show*) { return true; });
+    }
+
+    // Shows starting in [from, to], e.g. ("6:00 PM", "9:00 PM"). Empty if
+    // from is later than to (no wrap past midnight) or either bound is not
+    // a valid slot.
+    vector<Show*> shows_between(const string& from, const string& to, int min_free = 0) const {
+        vector<Show*> out;
+        int lo = slot_minutes(from), hi = slot_minutes(to);
+        if (lo < 0 || hi < 0 || lo > hi) return out;
+        auto last = by_start.upper_bound(hi);
+        for (auto it = by_start.lower_bound(lo); it != last; ++it)
+            for (Show* s : collect(it->second, [&](Show* s) { return s->seat_map.available() >= min_free; }))
+                out.push_back(s);
+        return out;
+    }
+
+    const string& city_of(const Show* show) const { return cities[halls[show->hall_id].city_id]; }
+    const vector<unique_ptr<Show>>& all_shows() const { return shows; }
+};
+
+void catalog_demo() {
+    ShowCatalog catalog;
+    int dune = catalog.add_movie({"Dune: Part Two", "Sci-Fi", 166});
+    int barbie = catalog.add_movie({"Barbie", "Comedy", 114});
+    int pvr = catalog.add_hall("PVR Koramangala", "Bangalore");
+    int inox = catalog.add_hall("INOX Garuda", "Bangalore");
+    int imax = catalog.add_hall("IMAX Wadala", "Mumbai");
+    vector<RowInfo> small(4, {SeatType::REGULAR, 10});
+
+    Show* s1 = catalog.add_show(dune, pvr, "6:00 PM", small, 8);
+    catalog.add_show(dune, inox, "9:30 PM", small, 8);
+    catalog.add_show(dune, imax, "7:00 PM", small, 8);
+    catalog.add_show(barbie, pvr, "8:00 PM", small, 8);
+
+    // A big group fills most of the 6 PM show through the normal booking path
+    BookingManager manager;
+    manager.set_logging(false);
+    for (int i = 0; i < 3; ++i) delete manager.book_best_available("Group", s1, 10, make_unique<NoOpPayment>());
+
+    cout << "\n--- Catalog: Dune: Part Two in Bangalore with >= 4 seats free ---\n";
+    for (Show* s : catalog.find_shows("Dune: Part Two", "Bangalore", 4))
+        cout << "  " << s->time_slot << " @ " << s->hall_name << " (" << s->seat_map.available() << " free)\n";
+    cout << "  (6:00 PM @ PVR has only " << s1->seat_map.available() << " free)\n";
+    cout << "  Shows between 7:00 PM and 9:00 PM: ";
+    for (Show* s : catalog.shows_between("7:00 PM", "9:00 PM"))
+        cout << s->movie.title << " @ " << s->hall_name << " (" << catalog.city_of(s) << "); ";
+    cout << "\n";
+    try {
+        catalog.add_show(barbie, inox, "Evening", small, 8);
+    } catch (const invalid_argument& e) {
+        cout << "  Rejected: " << e.what() << "\n";
+    }
+
+    // Scale: 20,000 shows, query indexed vs walking every show's seat array
+    ShowCatalog big;
+    vector<string> city_names;
+    for (int c = 0; c < 20; ++c) city_names.push_back("City " + to_string(c));
+    for (int m = 0; m < 200; ++m) big.add_movie({"Movie " + to_string(m), "Drama", 120});
+    for (int h = 0; h < 500; ++h) big.add_hall("Hall " + to_string(h), city_names[h % 20]);
+    mt19937 rng(11);
+    vector<RowInfo> layout(10, {SeatType::REGULAR, 10});
+    const char* slots[] = {"10:00 AM", "1:00 PM", "4:00 PM", "7:00 PM", "10:00 PM"};
+    for (int i = 0; i < 20000; ++i) {
+        Show* s = big.add_show(rng() % 200, rng() % 500, slots[i % 5], layout, 20);
+        int sold = rng() % 200;
+        for (int k = 0; k < sold; ++k) s->seat_map.try_lock(k);
+    }
+
+    const int queries = 2000;
+    size_t hits = 0;
+    auto start = chrono::steady_clock::now();
+    for (int q = 0; q < queries; ++q)
+        hits += big.find_shows("Movie " + to_string(q % 200), city_names[q % 20], 50).size();
+    double indexed_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / queries;
+
+    const int scans = 20;
+    size_t scan_hits = 0;
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < scans; ++q) {
+        string title = "Movie " + to_string(q % 200);
+        for (auto& s : big.all_shows())
+            if (s->movie.title == title && big.city_of(s.get()) == city_names[q % 20] &&
+                s->seat_map.count(SeatStatus::AVAILABLE) >= 50) ++scan_hits;
+    }
+    double scan_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / scans;
+
+    cout << "\n--- Catalog query: 20000 shows, 200 movies, 20 cities ---\n";
+    cout << "  indexed + counters : " << fixed << setprecision(2) << setw(9) << indexed_us << " us/query ("
+         << setprecision(1) << static_cast<double>(hits) / queries << " matches avg)\n";
+    cout << "  walk all + scan    : " << setprecision(2) << setw(9) << scan_us << " us/query\n";
+}
+
+// ==========================================
+// JOURNAL DEMO (crash + replay) AND GROUP COMMIT BENCHMARK
+// ==========================================
+// Rebuilds seat maps from the journal: each record re-books its seats
+int rebuild_from_journal(const string& path, ShowCatalog& catalog, BookingManager& manager) {
+    int max_id = 0;
+    int n = BookingJournal::replay(path, [&](const JournalRecord& rec) {
+        if (rec.show_id < 1 || rec.show_id > static_cast<int>(catalog.all_shows().size())) return;
+        SeatMap& seats = catalog.all_shows()[rec.show_id - 1]->seat_map;
+        vector<int> list(rec.seats, rec.seats + rec.seat_count);
+        if (seats.try_lock_all(list) < 0) seats.confirm_all(list);
+        max_id = max(max_id, static_cast<int>(rec.booking_id));
+    });
+    manager.resume_ids_after(max_id);
+    return n;
+}
+
+void journal_demo() {
+    string path = (filesystem::temp_directory_path() / "bookmyshow_journal.bin").string();
+    filesystem::remove(path);
+
+    auto build_catalog = [](ShowCatalog& catalog) {
+        int movie = catalog.add_movie({"Interstellar", "Sci-Fi", 169});
+        int hall = catalog.add_hall("Screen 1", "Pune");
+        catalog.add_show(movie, hall, "8:00 PM", vector<RowInfo>(3, {SeatType::REGULAR, 10}), 6);
+    };
+
+    cout << "\n--- Write-ahead journal: crash and replay ---\n";
+    {
+        ShowCatalog catalog;
+        build_catalog(catalog);
+        BookingJournal journal(path);
+        BookingManager manager;
+        manager.set_logging(false);
+        manager.set_journal(&journal);
+        Show* show = catalog.all_shows()[0].get();
+        delete manager.book_best_available("Hana", show, 4, make_unique<NoOpPayment>());
+        delete manager.book_best_available("Ivan", show, 2, make_unique<NoOpPayment>());
+        delete manager.create_booking("Jun", show, {0, 1}, make_unique<NoOpPayment>());
+        show->display_seats();
+        cout << "  " << journal.record_count() << " bookings journaled. 💥 process crashes...\n";
+    }
+    {
+        // A half-written record at the tail (crash mid-append) must be ignored
+        int fd = ::open(path.c_str(), O_WRONLY | O_APPEND);
+        const char torn[] = "GNKB\x01\x00";
+        if (::write(fd, torn, sizeof(torn)) < 0) cout << "  (could not append torn tail)\n";
+        ::close(fd);
+    }
+    {
+        ShowCatalog catalog;
+        build_catalog(catalog);
+        BookingManager manager;
+        manager.set_logging(false);
+        int n = rebuild_from_journal(path, catalog, manager);
+        cout << "  Restart: replayed " << n << " records (torn tail truncated)";
+        catalog.all_shows()[0]->display_seats();
+        Booking* next = manager.create_booking("Kai", catalog.all_shows()[0].get(), {17}, make_unique<NoOpPayment>());
+        cout << "  Next booking id after replay: " << (next ? next->booking_id : -1) << "\n";
+        delete next;
+    }
+    filesystem::remove(path);
+
+    // Group commit: confirmations/sec vs batch window, 16 concurrent confirmers
+    const int clients = 16, per_client = 60;
+    cout << "\n--- Group commit: " << clients << " clients x " << per_client << " confirmations ("
+         << path << ") ---\n";
+    auto run = [&](const string& name, BookingJournal::CommitMode mode, chrono::microseconds window) {
+        filesystem::remove(path);
+        ShowCatalog catalog;
+        int movie = catalog.add_movie({"Bench", "Drama", 100});
+        int hall = catalog.add_hall("Hall", "Delhi");
+        Show* show = catalog.add_show(movie, hall, "7:00 PM", vector<RowInfo>(40, {SeatType::REGULAR, 10}), 50);
+        BookingJournal journal(path, mode, window);
+        BookingManager manager;
+        manager.set_logging(false);
+        manager.set_journal(&journal);
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> threads;
+        for (int c = 0; c < clients; ++c) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < per_client; ++i)
+                    delete manager.book_best_available("fan", show, 1, make_unique<NoOpPayment>());
+            });
+        }
+        for (auto& t : threads) t.join();
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        long n = journal.record_count(), syncs = journal.sync_count();
+        cout << "  " << left << setw(22) << name << right << fixed << setprecision(0) << setw(8) << n / secs
+             << " confirmations/s  " << setw(5) << syncs << " fdatasyncs  "
+             << setprecision(1) << setw(5) << static_cast<double>(n) / max(1L, syncs) << " per sync  "
+             << setprecision(1) << setw(7) << secs * 1e6 / n << " us/booking\n";
+    };
+    run("fdatasync per booking", BookingJournal::CommitMode::SYNC_EACH, chrono::microseconds(0));
+    run("group, no window", BookingJournal::CommitMode::GROUP, chrono::microseconds(0));
+    run("group, 200 us window", BookingJournal::CommitMode::GROUP, chrono::microseconds(200));
+    run("group, 1 ms window", BookingJournal::CommitMode::GROUP, chrono::microseconds(1000));
+    filesystem::remove(path);
+}
+
+// ==========================================
+// MAIN
+// ==========================================
+int main() {
+    // Setup
+    Movie avengers{"Avengers: Endgame", "Action", 181};
+    
+    // Create seats (2 rows x 5 cols): row A is VIP
+    Show show(avengers, "7:00 PM", "Screen 1",
+              {{SeatType::VIP, 15}, {SeatType::REGULAR, 10}}, 5);
+
+    show.display_seats();
+
+    BookingManager manager;
+
+    // User 1 books VIP seats A1, A2
+    Booking* b1 = manager.create_booking("Alice", &show, {0, 1}, make_unique<CreditCardPayment>());
+    if (b1) b1->print_ticket();
+
+    // User 2 tries to book seat A1 (already taken!)
+    Booking* b2 = manager.create_booking("Bob", &show, {0, 4}, make_unique<UPIPayment>());
+    if (b2) b2->print_ticket();
+
+    // User 3 tries the SAME seat as Alice → should FAIL
+    Booking* b3 = manager.create_booking("Charlie", &show, {0}, make_unique<CreditCardPayment>());
+    if (!b3) cout << "Charlie's booking failed as expected.\n";
+
+    // Malformed requests are refused before any seat is touched
+    Booking* dup = manager.create_booking("Dup", &show, {7, 7}, make_unique<UPIPayment>());
+    Booking* ghost = manager.create_booking("Ghost", &show, {show.seat_map.size()}, make_unique<UPIPayment>());
+    cout << "Duplicate seat request " << (dup ? "ACCEPTED (bug)" : "rejected")
+         << ", out-of-range seat request " << (ghost ? "ACCEPTED (bug)" : "rejected") << ".\n";
+    delete dup; delete ghost;
+
+    show.display_seats();
+
+    delete b1; delete b2;
+
+    hold_expiry_demo(show);
+    timer_wheel_benchmark();
+
+    stadium_demo();
+    group_hold_benchmark();
+    flash_sale_benchmark();
+    best_available_demo();
+    sharded_service_benchmark();
+    async_payment_benchmark();
+    booking_pool_benchmark();
+    catalog_demo();
+    journal_demo();
     return 0;
 }
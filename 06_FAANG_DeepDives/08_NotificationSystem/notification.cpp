@@ -5,6 +5,14 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <stdexcept>
 
 using namespace std;
 
@@ -31,12 +39,28 @@ struct Notification {
     Priority priority;
 };
 
+// --- Contact Kind ---
+// Which of a user's addresses a channel delivers to. Lets the fan-out pick
+// the contact by array index instead of comparing channel-name strings.
+enum class ContactKind { NAME, EMAIL, PHONE, COUNT };
+
 // --- Channel Interface (Strategy) ---
 class NotificationChannel {
 public:
     virtual ~NotificationChannel() = default;
     virtual void send(const string& recipient, const Notification& notif) = 0;
     virtual string channelName() const = 0;
+    virtual ContactKind contactKind() const { return ContactKind::NAME; }
+
+    // One provider call for many recipients of the same notification (bulk
+    // email / SMS / multicast push APIs). Default falls back to send().
+    virtual void sendBatch(const vector<const string*>& recipients, const Notification& notif) {
+        for (auto* r : recipients) send(*r, notif);
+    }
+
+    // Async dispatch calls send/sendBatch from one worker thread per channel
+    // unless the channel declares it can take concurrent calls.
+    virtual bool concurrentSendSafe() const { return false; }
 };
 
 class EmailChannel : public NotificationChannel {
@@ -47,6 +71,7 @@ public:
              << notif.title << ": " << notif.message << "\n";
     }
     string channelName() const override { return "Email"; }
+    ContactKind contactKind() const override { return ContactKind::EMAIL; }
 };
 
 class SMSChannel : public NotificationChannel {
@@ -57,6 +82,7 @@ public:
              << notif.title << "\n";
     }
     string channelName() const override { return "SMS"; }
+    ContactKind contactKind() const override { return ContactKind::PHONE; }
 };
 
 class PushChannel : public NotificationChannel {
@@ -81,81 +107,529 @@ public:
         wrapped_->send(recipient, notif);
         cout << "  📝 [LOG] ✅ Sent successfully.\n";
     }
+    void sendBatch(const vector<const string*>& recipients, const Notification& notif) override {
+        cout << "  📝 [LOG] Sending via " << wrapped_->channelName()
+             << " to " << recipients.size() << " recipients...\n";
+        wrapped_->sendBatch(recipients, notif);
+        cout << "  📝 [LOG] ✅ Batch sent successfully.\n";
+    }
     string channelName() const override { return wrapped_->channelName() + " (Logged)"; }
+    ContactKind contactKind() const override { return wrapped_->contactKind(); }
 };
 
 // --- User ---
 class User {
-    string name_;
-    string email_;
-    string phone_;
+    string contacts_[static_cast<int>(ContactKind::COUNT)];  // indexed by ContactKind
     vector<string> preferredChannels_;  // e.g., {"Email", "Push"}
 public:
     User(string name, string email, string phone, vector<string> channels)
-        : name_(move(name)), email_(move(email)), phone_(move(phone)),
-          preferredChannels_(move(channels)) {}
+        : preferredChannels_(move(channels)) {
+        contacts_[static_cast<int>(ContactKind::NAME)] = move(name);
+        contacts_[static_cast<int>(ContactKind::EMAIL)] = move(email);
+        contacts_[static_cast<int>(ContactKind::PHONE)] = move(phone);
+    }
 
-    const string& getName() const { return name_; }
-    const string& getEmail() const { return email_; }
-    const string& getPhone() const { return phone_; }
+    const string& getName() const { return contact(ContactKind::NAME); }
+    const string& getEmail() const { return contact(ContactKind::EMAIL); }
+    const string& getPhone() const { return contact(ContactKind::PHONE); }
     const vector<string>& getChannels() const { return preferredChannels_; }
 
-    string getContactFor(const string& channel) const {
-        if (channel == "Email") return email_;
-        if (channel == "SMS") return phone_;
-        if (channel == "Push") return name_;
-        return name_;
+    // Array lookup, no compares, no copy
+    const string& contact(ContactKind kind) const { return contacts_[static_cast<int>(kind)]; }
+};
+
+// --- Interned IDs ---
+// Event types and channels are named by strings at the API edge only; the
+// service interns each name once to a dense integer and every structure
+// on the fan-out path is a flat vector indexed by that integer.
+using EventId = int;
+using ChannelId = int;
+
+class NameRegistry {
+    unordered_map<string, int> ids_;
+    vector<string> names_;
+public:
+    int intern(const string& name) {
+        auto it = ids_.find(name);
+        if (it != ids_.end()) return it->second;
+        names_.push_back(name);
+        return ids_[name] = static_cast<int>(names_.size()) - 1;
+    }
+    int find(const string& name) const {
+        auto it = ids_.find(name);
+        return it == ids_.end() ? -1 : it->second;
+    }
+    const string& name(int id) const { return names_[id]; }
+    int size() const { return static_cast<int>(names_.size()); }
+};
+
+// --- Bounded Queue (backpressure) ---
+// push() blocks while the queue is full, so a slow channel slows the stage
+// feeding it instead of growing memory without bound.
+template <typename T>
+class BoundedQueue {
+    mutex mtx_;
+    condition_variable notFull_, notEmpty_;
+    deque<T> items_;
+    size_t capacity_;
+    bool closed_ = false;
+    size_t blockedPushes_ = 0;
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    void push(T item) {
+        unique_lock<mutex> lk(mtx_);
+        if (items_.size() >= capacity_) ++blockedPushes_;
+        notFull_.wait(lk, [&] { return items_.size() < capacity_ || closed_; });
+        items_.push_back(move(item));
+        notEmpty_.notify_one();
+    }
+
+    bool tryPush(T item) {
+        lock_guard<mutex> lk(mtx_);
+        if (items_.size() >= capacity_ || closed_) return false;
+        items_.push_back(move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // false once closed and drained
+    bool pop(T& out) {
+        unique_lock<mutex> lk(mtx_);
+        notEmpty_.wait(lk, [&] { return !items_.empty() || closed_; });
+        if (items_.empty()) return false;
+        out = move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> lk(mtx_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
     }
+
+    size_t blockedPushes() {
+        lock_guard<mutex> lk(mtx_);
+        return blockedPushes_;
+    }
+};
+
+// --- Async Dispatch Config ---
+struct AsyncConfig {
+    size_t eventQueueCapacity = 1024;    // pending notify() calls
+    size_t channelQueueCapacity = 64;    // pending batches per channel
+    size_t batchSize = 500;              // recipients per sendBatch call
+    int workersPerChannel = 2;           // only for channels with concurrentSendSafe()
 };
 
 // --- Notification Service (Observer) ---
+// Subscriptions and channels are set up before startAsync(); the async
+// pipeline reads the delivery arrays without locks, so registerChannel,
+// registerEvent and subscribe throw while async dispatch is running.
 class NotificationService {
-    unordered_map<string, unique_ptr<NotificationChannel>> channels_;
-    unordered_map<string, vector<User*>> subscriptions_;  // event_type → users
+    // One resolved (channel, address) pair per subscriber per preferred channel
+    struct Delivery {
+        ChannelId channel;
+        const string* contact;   // points into the User, never copied
+    };
+
+    NameRegistry channelNames_;
+    NameRegistry eventNames_;
+    vector<unique_ptr<NotificationChannel>> channels_;   // ChannelId → channel
+    vector<vector<User*>> subscriptions_;                // EventId → users
+    vector<vector<Delivery>> deliveries_;                // EventId → flat fan-out list
+    vector<bool> dirty_;                                 // EventId → rebuild before next notify
+
+    // --- Async pipeline: notify → event queue → fan-out thread → per-channel
+    //     batch queues → channel worker pools → sendBatch ---
+    struct EventJob {
+        EventId event;
+        shared_ptr<const Notification> notif;
+    };
+    struct DeliveryBatch {
+        shared_ptr<const Notification> notif;
+        vector<const string*> recipients;
+    };
+    struct ChannelPipeline {
+        BoundedQueue<DeliveryBatch> queue;
+        vector<thread> workers;
+        atomic<size_t> batchesSent{0};
+        atomic<size_t> batchesFailed{0};      // sendBatch threw
+        explicit ChannelPipeline(size_t capacity) : queue(capacity) {}
+    };
+
+    AsyncConfig config_;
+    unique_ptr<BoundedQueue<EventJob>> eventQueue_;
+    vector<unique_ptr<ChannelPipeline>> pipelines_;      // ChannelId → pipeline
+    thread fanOutThread_;
+    bool async_ = false;
+
+    // Outstanding work (events + batches) for flush()
+    mutex idleMtx_;
+    condition_variable idleCv_;
+    long outstanding_ = 0;
+
+    void addOutstanding(long delta) {
+        lock_guard<mutex> lk(idleMtx_);
+        outstanding_ += delta;
+        if (outstanding_ == 0) idleCv_.notify_all();
+    }
+
+    void fanOutLoop() {
+        EventJob job;
+        vector<DeliveryBatch> open(channels_.size());
+        while (eventQueue_->pop(job)) {
+            auto flushBatch = [&](ChannelId ch) {
+                addOutstanding(1);
+                pipelines_[ch]->queue.push(move(open[ch]));   // blocks if channel is backed up
+                open[ch] = DeliveryBatch{};
+            };
+            for (const Delivery& d : deliveries_[job.event]) {
+                DeliveryBatch& b = open[d.channel];
+                if (b.recipients.empty()) {
+                    b.notif = job.notif;
+                    b.recipients.reserve(config_.batchSize);
+                }
+                b.recipients.push_back(d.contact);
+                if (b.recipients.size() >= config_.batchSize) flushBatch(d.channel);
+            }
+            for (ChannelId ch = 0; ch < static_cast<int>(open.size()); ++ch)
+                if (!open[ch].recipients.empty()) flushBatch(ch);
+            addOutstanding(-1);
+        }
+    }
+
+    // Un-counts one unit of outstanding work however the scope is left
+    struct OutstandingDone {
+        NotificationService& service;
+        ~OutstandingDone() { service.addOutstanding(-1); }
+    };
+
+    void channelWorkerLoop(ChannelId ch) {
+        ChannelPipeline& pipeline = *pipelines_[ch];
+        DeliveryBatch batch;
+        while (pipeline.queue.pop(batch)) {
+            OutstandingDone done{*this};
+            // A provider error fails this batch only, not the worker thread
+            try {
+                channels_[ch]->sendBatch(batch.recipients, *batch.notif);
+                pipeline.batchesSent.fetch_add(1, memory_order_relaxed);
+            } catch (const exception& e) {
+                if (pipeline.batchesFailed.fetch_add(1, memory_order_relaxed) == 0)
+                    cerr << "  ❌ " << channelNames_.name(ch) << " batch failed: " << e.what() << "\n";
+            } catch (...) {
+                if (pipeline.batchesFailed.fetch_add(1, memory_order_relaxed) == 0)
+                    cerr << "  ❌ " << channelNames_.name(ch) << " batch failed\n";
+            }
+            batch = DeliveryBatch{};
+        }
+    }
+
+    void appendDeliveries(EventId event, const User& user) {
+        for (auto& channelName : user.getChannels()) {
+            ChannelId ch = channelNames_.find(channelName);
+            if (ch >= 0 && channels_[ch])
+                deliveries_[event].push_back({ch, &user.contact(channels_[ch]->contactKind())});
+        }
+    }
+
+    const vector<Delivery>& deliveriesFor(EventId event) {
+        if (dirty_[event]) {
+            deliveries_[event].clear();
+            for (auto* user : subscriptions_[event]) appendDeliveries(event, *user);
+            dirty_[event] = false;
+        }
+        return deliveries_[event];
+    }
+
+    void requireSync(const char* what) const {
+        if (async_) throw logic_error(string(what) + " while async dispatch is running; call stopAsync() first");
+    }
 
 public:
-    void registerChannel(const string& name, unique_ptr<NotificationChannel> channel) {
-        channels_[name] = move(channel);
+    ChannelId registerChannel(const string& name, unique_ptr<NotificationChannel> channel) {
+        requireSync("registerChannel");
+        ChannelId id = channelNames_.intern(name);
+        if (id >= static_cast<int>(channels_.size())) channels_.resize(id + 1);
+        channels_[id] = move(channel);
+        // Existing subscribers may prefer this channel: re-resolve lazily
+        dirty_.assign(dirty_.size(), true);
         cout << "  ✅ Channel registered: " << name << "\n";
+        return id;
+    }
+
+    EventId registerEvent(const string& eventType) {
+        EventId id = eventNames_.find(eventType);
+        if (id >= 0) return id;
+        requireSync("registerEvent");
+        id = eventNames_.intern(eventType);
+        if (id >= static_cast<int>(subscriptions_.size())) {
+            subscriptions_.resize(id + 1);
+            deliveries_.resize(id + 1);
+            dirty_.resize(id + 1, false);
+        }
+        return id;
+    }
+
+    EventId findEvent(const string& eventType) const { return eventNames_.find(eventType); }
+
+    void subscribe(EventId event, User* user) {
+        requireSync("subscribe");
+        subscriptions_[event].push_back(user);
+        if (!dirty_[event]) appendDeliveries(event, *user);
     }
 
     void subscribe(const string& eventType, User* user) {
-        subscriptions_[eventType].push_back(user);
+        subscribe(registerEvent(eventType), user);
         cout << "  ✅ " << user->getName() << " subscribed to: " << eventType << "\n";
     }
 
-    // Notify all subscribers of an event
+    // Notify all subscribers of an event: a linear walk over one flat array.
+    // In async mode this only enqueues the event and returns.
+    void notify(EventId event, const Notification& notif) {
+        if (async_) {
+            // startAsync() resolved every event, so deliveries_ is read-only here
+            addOutstanding(1);
+            eventQueue_->push({event, make_shared<const Notification>(notif)});   // blocks only if backed up
+            return;
+        }
+        for (const Delivery& d : deliveriesFor(event)) channels_[d.channel]->send(*d.contact, notif);
+    }
+
+    // --- Async dispatch lifecycle ---
+    void startAsync(const AsyncConfig& config = AsyncConfig{}) {
+        if (async_) return;
+        config_ = config;
+        // Resolve lazily-built fan-out lists now: the fan-out thread reads them
+        // and concurrent publishers must not rebuild them
+        for (EventId e = 0; e < static_cast<int>(deliveries_.size()); ++e) deliveriesFor(e);
+        eventQueue_ = make_unique<BoundedQueue<EventJob>>(config.eventQueueCapacity);
+        pipelines_.clear();
+        for (size_t ch = 0; ch < channels_.size(); ++ch)
+            pipelines_.push_back(make_unique<ChannelPipeline>(config.channelQueueCapacity));
+        // Start workers only once pipelines_ is fully built (workers index it)
+        for (ChannelId ch = 0; ch < static_cast<int>(channels_.size()); ++ch) {
+            if (!channels_[ch]) continue;
+            int workers = channels_[ch]->concurrentSendSafe() ? max(1, config.workersPerChannel) : 1;
+            for (int w = 0; w < workers; ++w)
+                pipelines_[ch]->workers.emplace_back([this, ch] { channelWorkerLoop(ch); });
+        }
+        fanOutThread_ = thread([this] { fanOutLoop(); });
+        async_ = true;
+    }
+
+    // Block until every enqueued notification has been handed to its channels
+    void flush() {
+        unique_lock<mutex> lk(idleMtx_);
+        idleCv_.wait(lk, [&] { return outstanding_ == 0; });
+    }
+
+    void stopAsync() {
+        if (!async_) return;
+        flush();
+        eventQueue_->close();
+        fanOutThread_.join();
+        for (auto& p : pipelines_) {
+            p->queue.close();
+            for (auto& w : p->workers) w.join();
+        }
+        async_ = false;
+    }
+
+    size_t batchesSent(ChannelId ch) const { return pipelines_[ch]->batchesSent.load(); }
+    size_t batchesFailed(ChannelId ch) const { return pipelines_[ch]->batchesFailed.load(); }
+    size_t backpressureWaits(ChannelId ch) const { return pipelines_[ch]->queue.blockedPushes(); }
+
+    ~NotificationService() { stopAsync(); }
+
+    // Name-based entry point: one hash lookup per event, not per recipient
     void notify(const string& eventType, const Notification& notif) {
         cout << "\n  🔔 Event: " << eventType << "\n";
-        auto it = subscriptions_.find(eventType);
-        if (it == subscriptions_.end()) {
+        EventId event = findEvent(eventType);
+        if (event < 0 || subscriptions_[event].empty()) {
             cout << "  No subscribers for this event.\n";
             return;
         }
-
-        for (auto* user : it->second) {
-            for (auto& channelName : user->getChannels()) {
-                auto ch = channels_.find(channelName);
-                if (ch != channels_.end()) {
-                    string contact = user->getContactFor(channelName);
-                    ch->second->send(contact, notif);
-                }
-            }
-        }
+        notify(event, notif);
     }
 
-    // Direct notification to a specific user
+    // Direct notification to a specific user. In async mode each channel
+    // gets a one-recipient batch on its pipeline, so channels still only see
+    // their own workers; the User must outlive the delivery.
     void sendDirect(User& user, const Notification& notif) {
+        shared_ptr<const Notification> shared;
         for (auto& channelName : user.getChannels()) {
-            auto ch = channels_.find(channelName);
-            if (ch != channels_.end()) {
-                string contact = user.getContactFor(channelName);
-                ch->second->send(contact, notif);
+            ChannelId ch = channelNames_.find(channelName);
+            if (ch < 0 || !channels_[ch]) continue;
+            const string& contact = user.contact(channels_[ch]->contactKind());
+            if (!async_) {
+                channels_[ch]->send(contact, notif);
+                continue;
             }
+            if (!shared) shared = make_shared<const Notification>(notif);
+            addOutstanding(1);
+            pipelines_[ch]->queue.push({shared, {&contact}});
         }
     }
 };
 
+// ==========================================
+// Fan-out Benchmark (string-keyed vs interned)
+// ==========================================
+class CountingChannel : public NotificationChannel {
+    string name_;
+    ContactKind kind_;
+public:
+    size_t sent = 0, bytes = 0;
+    CountingChannel(string name, ContactKind kind) : name_(move(name)), kind_(kind) {}
+    void send(const string& recipient, const Notification&) override { ++sent; bytes += recipient.size(); }
+    string channelName() const override { return name_; }
+    ContactKind contactKind() const override { return kind_; }
+};
+
+void benchmarkFanOut() {
+    const int subscribers = 200000;
+    vector<User> users;
+    users.reserve(subscribers);
+    for (int i = 0; i < subscribers; ++i) {
+        string id = to_string(i);
+        users.emplace_back("user" + id, "user" + id + "@example.com", "+91" + id,
+                           i % 2 ? vector<string>{"Email", "Push"} : vector<string>{"Email", "SMS"});
+    }
+    Notification flashSale{"Flash Sale", "50% off for the next hour!", Priority::HIGH};
+
+    // Baseline: the original string-keyed layout and lookups
+    unordered_map<string, unique_ptr<NotificationChannel>> byName;
+    byName["Email"] = make_unique<CountingChannel>("Email", ContactKind::EMAIL);
+    byName["SMS"] = make_unique<CountingChannel>("SMS", ContactKind::PHONE);
+    byName["Push"] = make_unique<CountingChannel>("Push", ContactKind::NAME);
+    unordered_map<string, vector<User*>> byEvent;
+    for (auto& u : users) byEvent["FLASH_SALE"].push_back(&u);
+    auto contactFor = [](const User& u, const string& channel) -> string {
+        if (channel == "Email") return u.getEmail();
+        if (channel == "SMS") return u.getPhone();
+        return u.getName();
+    };
+
+    auto start = chrono::steady_clock::now();
+    auto it = byEvent.find("FLASH_SALE");
+    for (auto* user : it->second) {
+        for (auto& channelName : user->getChannels()) {
+            auto ch = byName.find(channelName);
+            if (ch != byName.end()) ch->second->send(contactFor(*user, channelName), flashSale);
+        }
+    }
+    double stringMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Interned: same users, same channels
+    NotificationService service;
+    cout << "\n--- Fan-out benchmark setup ---\n";
+    service.registerChannel("Email", make_unique<CountingChannel>("Email", ContactKind::EMAIL));
+    service.registerChannel("SMS", make_unique<CountingChannel>("SMS", ContactKind::PHONE));
+    service.registerChannel("Push", make_unique<CountingChannel>("Push", ContactKind::NAME));
+    EventId sale = service.registerEvent("FLASH_SALE");
+    for (auto& u : users) service.subscribe(sale, &u);
+    service.notify(sale, flashSale);   // warm: resolve deliveries once
+
+    start = chrono::steady_clock::now();
+    service.notify(sale, flashSale);
+    double internedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "\n--- Fan-out: 1 event → " << subscribers << " subscribers x 2 channels ---\n";
+    cout << "  string-keyed (hash per recipient + copied contact): " << fixed << setprecision(2)
+         << setw(8) << stringMs << " ms\n";
+    cout << "  interned ids (flat delivery array)               : " << setw(8) << internedMs << " ms\n";
+}
+
+// ==========================================
+// Async Dispatch Benchmark
+// ==========================================
+// Fake provider: every API call costs a fixed round-trip, whether it
+// carries one recipient or a whole batch
+class ProviderChannel : public NotificationChannel {
+    string name_;
+    ContactKind kind_;
+    chrono::microseconds callLatency_;
+public:
+    atomic<size_t> delivered{0}, apiCalls{0};
+    ProviderChannel(string name, ContactKind kind, chrono::microseconds latency)
+        : name_(move(name)), kind_(kind), callLatency_(latency) {}
+
+    void send(const string&, const Notification&) override {
+        this_thread::sleep_for(callLatency_);
+        ++apiCalls;
+        ++delivered;
+    }
+    void sendBatch(const vector<const string*>& recipients, const Notification&) override {
+        this_thread::sleep_for(callLatency_);
+        ++apiCalls;
+        delivered += recipients.size();
+    }
+    string channelName() const override { return name_; }
+    ContactKind contactKind() const override { return kind_; }
+    bool concurrentSendSafe() const override { return true; }   // atomic counters only
+};
+
+void benchmarkAsyncDispatch() {
+    const int subscribers = 4000, events = 3;
+    const auto latency = chrono::microseconds(50);
+    vector<User> users;
+    users.reserve(subscribers);
+    for (int i = 0; i < subscribers; ++i) {
+        string id = to_string(i);
+        users.emplace_back("user" + id, "user" + id + "@example.com", "+91" + id, vector<string>{"Email", "Push"});
+    }
+    Notification alert{"Price Drop", "An item on your wishlist is 30% off.", Priority::MEDIUM};
+
+    auto build = [&](NotificationService& service) {
+        auto* email = new ProviderChannel("Email", ContactKind::EMAIL, latency);
+        auto* push = new ProviderChannel("Push", ContactKind::NAME, latency);
+        service.registerChannel("Email", unique_ptr<NotificationChannel>(email));
+        service.registerChannel("Push", unique_ptr<NotificationChannel>(push));
+        EventId ev = service.registerEvent("PRICE_DROP");
+        for (auto& u : users) service.subscribe(ev, &u);
+        return make_pair(ev, make_pair(email, push));
+    };
+
+    cout << "\n--- Async dispatch setup ---\n";
+    NotificationService syncService, asyncService;
+    auto [syncEv, syncCh] = build(syncService);
+    auto [asyncEv, asyncCh] = build(asyncService);
+
+    // Synchronous: publisher waits for every provider call
+    auto start = chrono::steady_clock::now();
+    syncService.notify(syncEv, alert);
+    double syncMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Async + batched: publisher only enqueues
+    AsyncConfig cfg;
+    cfg.batchSize = 500;
+    cfg.workersPerChannel = 4;
+    cfg.channelQueueCapacity = 8;
+    asyncService.startAsync(cfg);
+    start = chrono::steady_clock::now();
+    for (int e = 0; e < events; ++e) asyncService.notify(asyncEv, alert);
+    double publishUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    asyncService.flush();
+    double asyncMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    asyncService.stopAsync();
+
+    size_t syncDelivered = syncCh.first->delivered + syncCh.second->delivered;
+    size_t asyncDelivered = asyncCh.first->delivered + asyncCh.second->delivered;
+    cout << "\n--- Dispatch: " << subscribers << " subscribers x 2 channels, provider call = "
+         << latency.count() << " us ---\n";
+    cout << "  sync, per-recipient send : 1 event, publisher blocked " << fixed << setprecision(1)
+         << syncMs << " ms, " << syncDelivered << " delivered in "
+         << syncCh.first->apiCalls + syncCh.second->apiCalls << " API calls\n";
+    cout << "  async, batched sendBatch : " << events << " events, publisher blocked " << setprecision(1)
+         << publishUs << " us, all delivered after " << asyncMs << " ms (" << asyncDelivered << " delivered in "
+         << asyncCh.first->apiCalls + asyncCh.second->apiCalls << " API calls, "
+         << asyncService.backpressureWaits(0) + asyncService.backpressureWaits(1) << " backpressure waits)\n";
+}
+
 int main() {
     cout << "=== Notification System ===" << endl;
 
@@ -208,5 +682,7 @@ int main() {
         Priority::LOW
     });
 
+    benchmarkFanOut();
+    benchmarkAsyncDispatch();
     return 0;
 }
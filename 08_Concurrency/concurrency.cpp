@@ -6,6 +6,34 @@
 #include <vector>
 #include <chrono>
 #include <string>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <deque>
+#include <unordered_map>
+#include <cstring>
+#include <type_traits>
+#include <optional>
+#include <utility>
+#include <fstream>
+#include <cstdint>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#  if __has_include(<coroutine>)
+#    include <coroutine>
+#    define HAS_COROUTINES 1
+#  endif
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -186,6 +214,1729 @@ namespace DeadlockPrevention {
     }
 }
 
+// ==========================================
+// 6. SHARDED COUNTER (Contention-Free)
+// ==========================================
+// MutexFix serializes every increment on one lock, and a single
+// std::atomic still bounces its cache line between every core.
+// A sharded counter gives each thread its own cache-line-aligned slot,
+// so increments never touch a line another thread is writing.
+// Reads are rare (metrics scrape), so they pay for summing all slots.
+namespace ShardedCounting {
+    constexpr size_t CACHE_LINE = 64;
+
+    class ShardedCounter {
+        struct alignas(CACHE_LINE) Slot {
+            atomic<long long> value{0};
+        };
+
+        size_t mask_;
+        unique_ptr<Slot[]> slots_;
+
+        // Each thread is handed a stable slot the first time it touches
+        // ANY sharded counter; round-robin keeps threads on distinct lines.
+        static size_t threadSlot() {
+            static atomic<size_t> nextSlot{0};
+            thread_local size_t slot = nextSlot.fetch_add(1, memory_order_relaxed);
+            return slot;
+        }
+
+        static size_t roundUpPow2(size_t n) {
+            size_t p = 1;
+            while (p < n) p <<= 1;
+            return p;
+        }
+
+    public:
+        // Default: two slots per core, so a moderately oversubscribed
+        // process still rarely has two threads sharing a slot.
+        explicit ShardedCounter(size_t shards = 2 * thread::hardware_concurrency())
+            : mask_(roundUpPow2(shards == 0 ? 1 : shards) - 1),
+              slots_(new Slot[mask_ + 1]) {}
+
+        void increment(long long delta = 1) {
+            // relaxed: we only need atomicity, not ordering with other data
+            slots_[threadSlot() & mask_].value.fetch_add(delta, memory_order_relaxed);
+        }
+
+        // Combined read — a consistent total once writers have quiesced,
+        // a monotonic approximation while they are still running.
+        long long read() const {
+            long long total = 0;
+            for (size_t i = 0; i <= mask_; ++i)
+                total += slots_[i].value.load(memory_order_relaxed);
+            return total;
+        }
+
+        void reset() {
+            for (size_t i = 0; i <= mask_; ++i)
+                slots_[i].value.store(0, memory_order_relaxed);
+        }
+
+        size_t shards() const { return mask_ + 1; }
+    };
+
+    // Runs `body(times)` on `threads` threads and returns elapsed milliseconds.
+    double timeThreads(int threads, int times, const function<void(int)>& body) {
+        vector<thread> workers;
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) workers.emplace_back(body, times);
+        for (auto& w : workers) w.join();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    void demo() {
+        ShardedCounter counter;
+        thread t1([&] { for (int i = 0; i < 100000; ++i) counter.increment(); });
+        thread t2([&] { for (int i = 0; i < 100000; ++i) counter.increment(); });
+        t1.join();
+        t2.join();
+        cout << "  Sharded counter: " << counter.read() << " (expected 200000, "
+             << counter.shards() << " shards)\n";
+    }
+
+    void benchmark() {
+        const int times = 200000;
+        atomic<long long> single{0};
+        ShardedCounter sharded;
+
+        cout << "  threads |   mutex ms |  atomic ms | sharded ms\n";
+        for (int threads : {1, 2, 4, 8}) {
+            MutexFix::counter = 0;
+            single = 0;
+            sharded.reset();
+
+            double mutexMs = timeThreads(threads, times, MutexFix::increment);
+            double atomicMs = timeThreads(threads, times, [&](int n) {
+                for (int i = 0; i < n; ++i) single.fetch_add(1, memory_order_relaxed);
+            });
+            double shardedMs = timeThreads(threads, times, [&](int n) {
+                for (int i = 0; i < n; ++i) sharded.increment();
+            });
+
+            long long expected = 1LL * threads * times;
+            bool ok = MutexFix::counter == expected && single == expected && sharded.read() == expected;
+            cout << fixed << setprecision(2)
+                 << "  " << setw(7) << threads << " | " << setw(10) << mutexMs
+                 << " | " << setw(10) << atomicMs << " | " << setw(10) << shardedMs
+                 << (ok ? "" : "  (COUNT MISMATCH!)") << "\n";
+        }
+    }
+}
+
+// ==========================================
+// 7. ADAPTIVE MUTEX (Spin-then-Park) + CONTENTION STATS
+// ==========================================
+// For tiny critical sections, std::mutex often puts a waiter to sleep
+// just before the owner releases — the futex round trip costs far more
+// than the work being protected. AdaptiveMutex spins with bounded
+// exponential backoff first and only parks on a futex if that fails.
+// It exposes lock()/try_lock()/unlock(), so lock_guard and scoped_lock
+// work unchanged.
+namespace AdaptiveLocking {
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Thin futex wrappers; other platforms fall back to yielding.
+    inline void futexWait(atomic<int>* addr, int expected) {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+        if (addr->load(memory_order_relaxed) == expected) this_thread::yield();
+#endif
+    }
+
+    inline void futexWake(atomic<int>* addr, int count) {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+        (void)addr; (void)count;
+#endif
+    }
+
+    // Contention stats shared by every lock with the same owner label
+    // (e.g. all 5,000 seat locks of a show report as "BookMyShow.Seat").
+    struct LockStats {
+        static constexpr int BUCKETS = 40;   // log2(ns) wait-time buckets
+
+        string owner;
+        atomic<long long> acquisitions{0};
+        atomic<long long> contended{0};
+        atomic<long long> parked{0};
+        atomic<long long> totalWaitNs{0};
+        atomic<long long> waitHistogram[BUCKETS] = {};
+
+        explicit LockStats(string o) : owner(move(o)) {}
+
+        void recordWait(long long ns, bool didPark) {
+            contended.fetch_add(1, memory_order_relaxed);
+            if (didPark) parked.fetch_add(1, memory_order_relaxed);
+            totalWaitNs.fetch_add(ns, memory_order_relaxed);
+            int bucket = 0;
+            while (bucket < BUCKETS - 1 && (1LL << (bucket + 1)) <= ns) ++bucket;
+            waitHistogram[bucket].fetch_add(1, memory_order_relaxed);
+        }
+
+        // Upper bound of the bucket holding the given percentile of waits.
+        long long waitPercentileNs(double pct) const {
+            long long total = contended.load(memory_order_relaxed);
+            if (total == 0) return 0;
+            long long target = static_cast<long long>(total * pct / 100.0), seen = 0;
+            for (int b = 0; b < BUCKETS; ++b) {
+                seen += waitHistogram[b].load(memory_order_relaxed);
+                if (seen > target) return 1LL << (b + 1);
+            }
+            return 1LL << BUCKETS;
+        }
+    };
+
+    // Process-wide registry (Meyers' Singleton) so stats outlive the locks.
+    class LockRegistry {
+        mutex mtx_;
+        map<string, unique_ptr<LockStats>> stats_;
+        LockRegistry() = default;
+    public:
+        static LockRegistry& getInstance() {
+            static LockRegistry instance;
+            return instance;
+        }
+
+        LockStats* statsFor(const string& owner) {
+            lock_guard<mutex> lock(mtx_);
+            auto& slot = stats_[owner];
+            if (!slot) slot = make_unique<LockStats>(owner);
+            return slot.get();
+        }
+
+        // Hottest locks first, ranked by total time threads spent waiting.
+        void printReport(size_t top = 10) {
+            lock_guard<mutex> lock(mtx_);
+            vector<LockStats*> sorted;
+            for (auto& [_, st] : stats_) sorted.push_back(st.get());
+            sort(sorted.begin(), sorted.end(), [](LockStats* a, LockStats* b) {
+                return a->totalWaitNs.load() > b->totalWaitNs.load();
+            });
+
+            cout << "  owner                    |     acquired |  contended |  parked |  wait ms |  p50 ns |  p99 ns\n";
+            for (size_t i = 0; i < sorted.size() && i < top; ++i) {
+                LockStats* st = sorted[i];
+                cout << "  " << left << setw(24) << st->owner << right
+                     << " | " << setw(12) << st->acquisitions.load()
+                     << " | " << setw(10) << st->contended.load()
+                     << " | " << setw(7) << st->parked.load()
+                     << " | " << setw(8) << fixed << setprecision(2) << st->totalWaitNs.load() / 1e6
+                     << " | " << setw(7) << st->waitPercentileNs(50)
+                     << " | " << setw(7) << st->waitPercentileNs(99) << "\n";
+            }
+        }
+    };
+
+    class AdaptiveMutex {
+        static constexpr int MAX_SPIN_ROUNDS = 10;   // 1 + 2 + ... + 512 pauses
+
+        // 0 = unlocked, 1 = locked, 2 = locked and a waiter may be parked
+        atomic<int> state_{0};
+        LockStats* stats_;
+        long long localAcquisitions_ = 0;   // guarded by the lock itself
+
+        void flushAcquisitions() {
+            stats_->acquisitions.fetch_add(localAcquisitions_, memory_order_relaxed);
+            localAcquisitions_ = 0;
+        }
+
+        void lockSlow() {
+            auto start = chrono::steady_clock::now();
+            bool didPark = false;
+
+            bool acquired = false;
+            for (int round = 0, spins = 1; !acquired && round < MAX_SPIN_ROUNDS; ++round, spins <<= 1) {
+                for (int i = 0; i < spins; ++i) cpuRelax();
+                int c = state_.load(memory_order_relaxed);
+                acquired = c == 0 && state_.compare_exchange_weak(c, 1, memory_order_acquire);
+            }
+
+            // Spinning failed — mark the lock as having waiters and sleep.
+            // Once parked we must keep state 2, since other waiters may exist.
+            if (!acquired) {
+                while (state_.exchange(2, memory_order_acquire) != 0) {
+                    didPark = true;
+                    futexWait(&state_, 2);
+                }
+            }
+
+            long long ns = chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - start).count();
+            stats_->recordWait(ns, didPark);
+            ++localAcquisitions_;
+            flushAcquisitions();   // already on the slow path; keep counts fresh
+        }
+
+    public:
+        explicit AdaptiveMutex(const string& owner = "anonymous")
+            : stats_(LockRegistry::getInstance().statsFor(owner)) {}
+
+        AdaptiveMutex(const AdaptiveMutex&) = delete;
+        AdaptiveMutex& operator=(const AdaptiveMutex&) = delete;
+
+        ~AdaptiveMutex() { flushAcquisitions(); }
+
+        void lock() {
+            int c = 0;
+            if (!state_.compare_exchange_strong(c, 1, memory_order_acquire)) {
+                lockSlow();
+                return;
+            }
+            ++localAcquisitions_;
+        }
+
+        bool try_lock() {
+            int c = 0;
+            if (!state_.compare_exchange_strong(c, 1, memory_order_acquire)) return false;
+            ++localAcquisitions_;
+            return true;
+        }
+
+        void unlock() {
+            if (state_.exchange(0, memory_order_release) == 2) futexWake(&state_, 1);
+        }
+    };
+
+    // Hammers `locks` from several threads, each op picking a lock and doing
+    // `work` iterations inside it — a stand-in for the real call sites.
+    template <typename Mutex>
+    double hammer(vector<unique_ptr<Mutex>>& locks, int threads, int ops, int work) {
+        vector<thread> workers;
+        atomic<long long> sink{0};
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                unsigned x = 2463534242u + t;
+                long long local = 0;
+                for (int i = 0; i < ops; ++i) {
+                    x ^= x << 13; x ^= x >> 17; x ^= x << 5;   // xorshift
+                    lock_guard<Mutex> guard(*locks[x % locks.size()]);
+                    for (int w = 0; w < work; ++w) local += w ^ i;
+                }
+                sink += local;
+            });
+        }
+        for (auto& w : workers) w.join();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename Mutex, typename... Args>
+    vector<unique_ptr<Mutex>> makeLocks(size_t n, Args&&... args) {
+        vector<unique_ptr<Mutex>> locks;
+        for (size_t i = 0; i < n; ++i) locks.push_back(make_unique<Mutex>(args...));
+        return locks;
+    }
+
+    void demo() {
+        const int threads = 4, ops = 50000;
+
+        // Simulated lock profiles of the booking, parking and URL services.
+        auto seats   = makeLocks<AdaptiveMutex>(5000, "BookMyShow.Seat");
+        auto levels  = makeLocks<AdaptiveMutex>(4, "ParkingLot.Level");
+        auto urlRepo = makeLocks<AdaptiveMutex>(1, "UrlShortener.Repository");
+        hammer(seats, threads, ops, 20);
+        hammer(levels, threads, ops, 20);
+        hammer(urlRepo, threads, ops, 20);
+
+        // scoped_lock works too, since AdaptiveMutex provides try_lock().
+        {
+            scoped_lock both(*seats[0], *seats[1]);
+        }
+
+        cout << "  Hottest locks:\n";
+        seats.clear(); levels.clear(); urlRepo.clear();   // flush per-lock counts
+        LockRegistry::getInstance().printReport();
+    }
+
+    void benchmark() {
+        cout << "  One hot lock, tiny critical section:\n";
+        cout << "  threads | std::mutex ms | adaptive ms\n";
+        for (int threads : {1, 2, 4, 8}) {
+            auto stdLocks = makeLocks<mutex>(1);
+            auto adaptiveLocks = makeLocks<AdaptiveMutex>(1, "Benchmark.HotLock");
+            double stdMs = hammer(stdLocks, threads, 100000, 10);
+            double adaptiveMs = hammer(adaptiveLocks, threads, 100000, 10);
+            cout << fixed << setprecision(2) << "  " << setw(7) << threads
+                 << " | " << setw(13) << stdMs << " | " << setw(11) << adaptiveMs << "\n";
+        }
+    }
+}
+
+// ==========================================
+// 8. LOCK HIERARCHY CHECKER (Debug Builds)
+// ==========================================
+// scoped_lock only helps when ALL the locks are taken in one statement.
+// Larger code takes locks across function calls, where ABBA ordering bugs
+// hide until production load. Give every mutex a level (and optionally a
+// rank within the level); a thread may only acquire a lock that is LOWER
+// than every lock it already holds, or the same level with a HIGHER rank.
+// The check runs on every lock(), so an inversion is reported on the first
+// run that exercises it — no actual deadlock needed.
+//
+// Compile with -DLOCK_ORDER_CHECKING=0 (or -DNDEBUG) to turn the checks
+// into a plain forwarding wrapper.
+#ifndef LOCK_ORDER_CHECKING
+#  ifdef NDEBUG
+#    define LOCK_ORDER_CHECKING 0
+#  else
+#    define LOCK_ORDER_CHECKING 1
+#  endif
+#endif
+
+namespace LockOrdering {
+    class LockOrderViolation : public logic_error {
+    public:
+        using logic_error::logic_error;
+    };
+
+    struct HeldLock {
+        const void* mtx;
+        unsigned level;
+        unsigned rank;
+        const char* name;
+    };
+
+    // Per-thread stack of currently held ordered locks.
+    inline vector<HeldLock>& heldLocks() {
+        thread_local vector<HeldLock> held;
+        return held;
+    }
+
+    template <typename Mutex = mutex>
+    class OrderedMutex {
+        Mutex mtx_;
+        unsigned level_;
+        unsigned rank_;
+        const char* name_;
+
+        string describe(unsigned level, unsigned rank, const char* name) const {
+            return string(name) + "(level " + to_string(level) + ", rank " + to_string(rank) + ")";
+        }
+
+        void checkOrder() const {
+            for (const HeldLock& h : heldLocks()) {
+                if (h.mtx == this)
+                    throw LockOrderViolation("re-locking " + describe(level_, rank_, name_));
+                bool ordered = level_ < h.level || (level_ == h.level && rank_ > h.rank);
+                if (!ordered)
+                    throw LockOrderViolation("acquiring " + describe(level_, rank_, name_) +
+                                             " while holding " + describe(h.level, h.rank, h.name));
+            }
+        }
+
+        void pushHeld() { heldLocks().push_back({this, level_, rank_, name_}); }
+
+        void popHeld() {
+            // Usually the top entry, but unlock order is not guaranteed.
+            auto& held = heldLocks();
+            for (auto it = held.rbegin(); it != held.rend(); ++it) {
+                if (it->mtx == this) {
+                    held.erase(next(it).base());
+                    return;
+                }
+            }
+        }
+
+    public:
+        OrderedMutex(unsigned level, const char* name, unsigned rank = 0)
+            : level_(level), rank_(rank), name_(name) {}
+
+        void lock() {
+            if constexpr (LOCK_ORDER_CHECKING) checkOrder();   // throws BEFORE blocking
+            mtx_.lock();
+            if constexpr (LOCK_ORDER_CHECKING) pushHeld();
+        }
+
+        // try_lock can never deadlock, so it is tracked but not order-checked.
+        // That is also what lets std::lock/scoped_lock use its back-off dance.
+        bool try_lock() {
+            if (!mtx_.try_lock()) return false;
+            if constexpr (LOCK_ORDER_CHECKING) pushHeld();
+            return true;
+        }
+
+        void unlock() {
+            if constexpr (LOCK_ORDER_CHECKING) popHeld();
+            mtx_.unlock();
+        }
+
+        unsigned level() const { return level_; }
+        unsigned rank() const { return rank_; }
+    };
+
+    // Seat booking shape: show lock (level 2) then seat locks (level 1),
+    // ranked by seat index so multi-seat bookings must go left to right.
+    struct CheckedShow {
+        OrderedMutex<> showLock{2, "Show"};
+        vector<unique_ptr<OrderedMutex<>>> seatLocks;
+
+        explicit CheckedShow(int seats) {
+            for (int i = 0; i < seats; ++i)
+                seatLocks.push_back(make_unique<OrderedMutex<>>(1, "Seat", i));
+        }
+
+        // Locks seats in the order the caller listed them — the same
+        // behaviour as BookingManager::create_booking.
+        void book(const vector<int>& seatIndices) {
+            lock_guard<OrderedMutex<>> show(showLock);
+            vector<unique_lock<OrderedMutex<>>> held;
+            for (int idx : seatIndices) held.emplace_back(*seatLocks[idx]);
+        }
+    };
+
+    void demo() {
+        if (!LOCK_ORDER_CHECKING) {
+            cout << "  Lock-order checking compiled out (LOCK_ORDER_CHECKING=0).\n";
+            return;
+        }
+
+        CheckedShow show(10);
+        atomic<int> ok{0}, violations{0};
+        string firstViolation;
+        mutex reportMtx;
+
+        // Stress: one user books seats ascending, another descending.
+        auto user = [&](vector<int> seats) {
+            for (int i = 0; i < 1000; ++i) {
+                try {
+                    show.book(seats);
+                    ok++;
+                } catch (const LockOrderViolation& e) {
+                    if (violations++ == 0) {
+                        lock_guard<mutex> lock(reportMtx);
+                        firstViolation = e.what();
+                    }
+                }
+            }
+        };
+        thread t1(user, vector<int>{2, 3, 4});
+        thread t2(user, vector<int>{4, 3, 2});
+        t1.join();
+        t2.join();
+
+        cout << "  Bookings OK: " << ok << ", order violations caught: " << violations << "\n";
+        cout << "  First violation: " << firstViolation << "\n";
+
+        // scoped_lock still works: it locks one and try_locks the rest.
+        {
+            scoped_lock both(*show.seatLocks[7], *show.seatLocks[5]);
+            cout << "  scoped_lock over seats 7 and 5 acquired without a false positive.\n";
+        }
+        cout << "  Held locks after scope: " << heldLocks().size() << "\n";
+    }
+}
+
+// ==========================================
+// 9. EPOCH-BASED MEMORY RECLAMATION (EBR)
+// ==========================================
+// A lock-free reader may still be dereferencing a node that a writer just
+// unlinked, so the writer cannot delete it immediately. shared_ptr solves
+// this with a refcount — but every reader then does two atomic RMWs on the
+// same cache line. EBR lets readers announce "I'm inside epoch E" with one
+// store to their OWN line. A retired node is freed once the global epoch has
+// advanced twice past its retirement, because by then no reader that could
+// have seen it is still inside a critical section.
+namespace EpochReclamation {
+    class EpochManager {
+        static constexpr size_t MAX_THREADS = 128;
+        static constexpr size_t COLLECT_EVERY = 64;          // retires between collections
+        static constexpr uint64_t QUIESCENT = ~0ULL;          // "not reading"
+
+        struct Retired {
+            uint64_t epoch;
+            void* ptr;
+            void (*deleter)(void*);
+        };
+
+        struct alignas(64) Participant {
+            atomic<uint64_t> epoch{QUIESCENT};
+            atomic<bool> claimed{false};
+            int nesting = 0;                 // owner-thread only
+            deque<Retired> retired;          // owner-thread only, epochs ascending
+        };
+
+        atomic<uint64_t> globalEpoch_{0};
+        Participant participants_[MAX_THREADS];
+        mutex orphanMtx_;
+        deque<Retired> orphans_;             // retire lists of exited threads
+
+        EpochManager() = default;
+
+        // Registers the calling thread on first use; unregisters on thread exit.
+        struct ThreadHandle {
+            Participant* p = nullptr;
+            ~ThreadHandle() { if (p) EpochManager::getInstance().unregister(p); }
+        };
+
+        Participant& self() {
+            thread_local ThreadHandle handle;
+            if (!handle.p) {
+                for (auto& p : participants_) {
+                    bool expected = false;
+                    if (p.claimed.compare_exchange_strong(expected, true)) {
+                        handle.p = &p;
+                        break;
+                    }
+                }
+                if (!handle.p) throw runtime_error("EpochManager: too many threads");
+            }
+            return *handle.p;
+        }
+
+        void unregister(Participant* p) {
+            {
+                lock_guard<mutex> lock(orphanMtx_);
+                for (auto& r : p->retired) orphans_.push_back(r);
+            }
+            p->retired.clear();
+            p->epoch.store(QUIESCENT, memory_order_release);
+            p->claimed.store(false, memory_order_release);
+        }
+
+        // The epoch can move from E to E+1 only once every active reader has
+        // observed E.
+        bool tryAdvance() {
+            uint64_t current = globalEpoch_.load(memory_order_acquire);
+            for (auto& p : participants_) {
+                if (!p.claimed.load(memory_order_acquire)) continue;
+                uint64_t e = p.epoch.load(memory_order_acquire);
+                if (e != QUIESCENT && e != current) return false;
+            }
+            return globalEpoch_.compare_exchange_strong(current, current + 1, memory_order_acq_rel);
+        }
+
+        static size_t freeSafe(deque<Retired>& list, uint64_t global) {
+            size_t freed = 0;
+            while (!list.empty() && list.front().epoch + 2 <= global) {
+                list.front().deleter(list.front().ptr);
+                list.pop_front();
+                ++freed;
+            }
+            return freed;
+        }
+
+    public:
+        static EpochManager& getInstance() {
+            static EpochManager instance;
+            return instance;
+        }
+
+        // Runs after every thread has exited, so nothing can still be reading.
+        ~EpochManager() { freeSafe(orphans_, QUIESCENT); }
+
+        // RAII read-side critical section. Pointers loaded inside a Guard
+        // stay valid until the Guard is destroyed. Guards may nest.
+        class Guard {
+            Participant& p_;
+        public:
+            explicit Guard(Participant& p) : p_(p) {
+                if (p_.nesting++ == 0) {
+                    p_.epoch.store(EpochManager::getInstance().globalEpoch_.load(memory_order_relaxed),
+                                   memory_order_relaxed);
+                    // Our epoch must be visible before we read any shared pointer.
+                    atomic_thread_fence(memory_order_seq_cst);
+                }
+            }
+            ~Guard() {
+                if (--p_.nesting == 0) p_.epoch.store(QUIESCENT, memory_order_release);
+            }
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+        };
+
+        Guard pin() { return Guard(self()); }
+
+        // Defers `delete ptr` until no reader can still hold it.
+        // Call only after `ptr` has been unlinked from every shared location.
+        template <typename T>
+        void retire(T* ptr) {
+            Participant& p = self();
+            p.retired.push_back({globalEpoch_.load(memory_order_acquire), ptr,
+                                 [](void* raw) { delete static_cast<T*>(raw); }});
+            if (p.retired.size() % COLLECT_EVERY == 0) collect();
+        }
+
+        // Tries to advance the epoch and frees whatever became safe.
+        size_t collect() {
+            tryAdvance();
+            uint64_t global = globalEpoch_.load(memory_order_acquire);
+            size_t freed = freeSafe(self().retired, global);
+            unique_lock<mutex> lock(orphanMtx_, try_to_lock);
+            if (lock.owns_lock()) freed += freeSafe(orphans_, global);
+            return freed;
+        }
+
+        size_t pendingInThisThread() { return self().retired.size(); }
+        uint64_t epoch() const { return globalEpoch_.load(memory_order_relaxed); }
+    };
+
+    // Read-mostly map (URL shortener lookups, library catalog): readers get a
+    // lock-free, refcount-free view; writers copy-on-write and retire the old map.
+    template <typename K, typename V>
+    class EbrReadMap {
+        using Map = unordered_map<K, V>;
+        atomic<const Map*> current_;
+        mutex writeMtx_;   // serializes writers only
+
+    public:
+        EbrReadMap() : current_(new Map()) {}
+        ~EbrReadMap() { delete current_.load(); }
+
+        bool find(const K& key, V& out) const {
+            auto guard = EpochManager::getInstance().pin();
+            const Map* m = current_.load(memory_order_acquire);
+            auto it = m->find(key);
+            if (it == m->end()) return false;
+            out = it->second;
+            return true;
+        }
+
+        void put(const K& key, const V& value) {
+            lock_guard<mutex> lock(writeMtx_);
+            const Map* old = current_.load(memory_order_relaxed);
+            Map* updated = new Map(*old);
+            (*updated)[key] = value;
+            current_.store(updated, memory_order_release);
+            EpochManager::getInstance().retire(const_cast<Map*>(old));
+        }
+    };
+
+    // Same copy-on-write map shared through atomic shared_ptr operations.
+    template <typename K, typename V>
+    class SharedPtrReadMap {
+        using Map = unordered_map<K, V>;
+        shared_ptr<const Map> current_ = make_shared<Map>();
+        mutex writeMtx_;
+
+    public:
+        bool find(const K& key, V& out) const {
+            shared_ptr<const Map> m = atomic_load(&current_);   // refcount ++ / --
+            auto it = m->find(key);
+            if (it == m->end()) return false;
+            out = it->second;
+            return true;
+        }
+
+        void put(const K& key, const V& value) {
+            lock_guard<mutex> lock(writeMtx_);
+            auto updated = make_shared<Map>(*atomic_load(&current_));
+            (*updated)[key] = value;
+            atomic_store(&current_, shared_ptr<const Map>(move(updated)));
+        }
+    };
+
+    // Readers look up short codes while one writer keeps adding mappings.
+    template <typename ReadMap>
+    double readBenchmark(int readers, int lookups) {
+        ReadMap urls;
+        for (int i = 0; i < 256; ++i) urls.put(i, "https://example.com/page/" + to_string(i));
+
+        atomic<bool> stop{false};
+        thread writer([&] {
+            for (int i = 256; !stop.load(memory_order_relaxed); ++i) {
+                urls.put(i % 512, "https://example.com/new/" + to_string(i));
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+        });
+
+        vector<thread> workers;
+        atomic<long long> hits{0};
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < readers; ++r) {
+            workers.emplace_back([&, r] {
+                string out;
+                long long local = 0;
+                for (int i = 0; i < lookups; ++i) local += urls.find((i * 7 + r) % 256, out);
+                hits += local;
+            });
+        }
+        for (auto& w : workers) w.join();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        stop = true;
+        writer.join();
+        return ms;
+    }
+
+    void demo() {
+        EbrReadMap<string, string> urls;
+        urls.put("abc123", "https://en.wikipedia.org/wiki/Read-copy-update");
+        urls.put("lld42", "https://github.com/dilsec20/low_level_design");
+        for (int i = 0; i < 200; ++i) urls.put("tmp" + to_string(i), "https://example.com");
+
+        string target;
+        if (urls.find("lld42", target)) cout << "  lld42 -> " << target << "\n";
+
+        auto& ebr = EpochManager::getInstance();
+        for (int i = 0; i < 3; ++i) ebr.collect();
+        cout << "  Global epoch: " << ebr.epoch()
+             << ", old maps still pending in this thread: " << ebr.pendingInThisThread() << "\n";
+    }
+
+    void benchmark() {
+        const int lookups = 200000;
+        cout << "  readers | shared_ptr ms |    EBR ms\n";
+        for (int readers : {1, 2, 4, 8}) {
+            double spMs = readBenchmark<SharedPtrReadMap<int, string>>(readers, lookups);
+            double ebrMs = readBenchmark<EbrReadMap<int, string>>(readers, lookups);
+            cout << fixed << setprecision(2) << "  " << setw(7) << readers
+                 << " | " << setw(13) << spMs << " | " << setw(9) << ebrMs << "\n";
+        }
+    }
+}
+
+// ==========================================
+// 10. SEQLOCK + SNAPSHOT READS (Read-Mostly State)
+// ==========================================
+// Singletons like SafeSingleton::Database mostly hand out configuration
+// that changes a few times a day. Guarding it with a mutex makes every
+// reader write to the mutex's cache line.
+//  - Seqlock<T>: for small trivially-copyable state. Writers bump a
+//    sequence number to odd, write, bump to even; readers copy the data
+//    and retry if the sequence moved. Readers never write shared memory.
+//  - SnapshotPtr<T>: RCU-style, for larger state. Writers publish a new
+//    immutable copy; readers pin an epoch (section 9) and use the old one.
+namespace SnapshotReads {
+    template <typename T>
+    class Seqlock {
+        static_assert(is_trivially_copyable<T>::value, "Seqlock<T> copies T byte-wise");
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        atomic<uint64_t> seq_{0};
+        // Stored as relaxed atomic words so the torn reads a seqlock
+        // tolerates are not undefined behaviour.
+        atomic<uint64_t> data_[WORDS] = {};
+
+        void storeWords(const T& value) {
+            uint64_t buf[WORDS] = {};
+            memcpy(buf, &value, sizeof(T));
+            for (size_t i = 0; i < WORDS; ++i) data_[i].store(buf[i], memory_order_relaxed);
+        }
+
+        // Claim the write side by moving the sequence from even to odd.
+        uint64_t beginWrite() {
+            uint64_t s = seq_.load(memory_order_relaxed);
+            while ((s & 1) || !seq_.compare_exchange_weak(s, s + 1, memory_order_acquire)) {
+                AdaptiveLocking::cpuRelax();
+                s = seq_.load(memory_order_relaxed);
+            }
+            atomic_thread_fence(memory_order_release);   // odd seq visible before data
+            return s;
+        }
+
+        void endWrite(uint64_t s) { seq_.store(s + 2, memory_order_release); }
+
+    public:
+        explicit Seqlock(const T& initial = T{}) { storeWords(initial); }
+
+        T load() const {
+            uint64_t buf[WORDS];
+            while (true) {
+                uint64_t before = seq_.load(memory_order_acquire);
+                if (before & 1) {                 // writer in progress
+                    AdaptiveLocking::cpuRelax();
+                    continue;
+                }
+                for (size_t i = 0; i < WORDS; ++i) buf[i] = data_[i].load(memory_order_relaxed);
+                atomic_thread_fence(memory_order_acquire);
+                if (seq_.load(memory_order_relaxed) == before) break;
+            }
+            T out;
+            memcpy(&out, buf, sizeof(T));
+            return out;
+        }
+
+        void store(const T& value) {
+            uint64_t s = beginWrite();
+            storeWords(value);
+            endWrite(s);
+        }
+
+        // Read-modify-write under the write claim, so concurrent updates
+        // from any number of threads never lose each other's changes.
+        // Keep fn short: readers spin while it runs.
+        template <typename Fn>
+        void update(Fn fn) {
+            uint64_t s = beginWrite();
+            uint64_t buf[WORDS];
+            for (size_t i = 0; i < WORDS; ++i) buf[i] = data_[i].load(memory_order_relaxed);
+            T value;
+            memcpy(&value, buf, sizeof(T));
+            fn(value);
+            storeWords(value);
+            endWrite(s);
+        }
+    };
+
+    template <typename T>
+    class SnapshotPtr {
+        atomic<const T*> current_;
+        mutex writeMtx_;   // serializes writers only
+
+    public:
+        explicit SnapshotPtr(T initial = T{}) : current_(new T(move(initial))) {}
+        ~SnapshotPtr() { delete current_.load(); }
+        SnapshotPtr(const SnapshotPtr&) = delete;
+        SnapshotPtr& operator=(const SnapshotPtr&) = delete;
+
+        // Calls fn(const T&) on a stable snapshot; no locks, no refcounts.
+        template <typename Fn>
+        auto read(Fn fn) const {
+            auto guard = EpochReclamation::EpochManager::getInstance().pin();
+            return fn(*current_.load(memory_order_acquire));
+        }
+
+        // Copies the current value, lets fn modify the copy, publishes it.
+        template <typename Fn>
+        void update(Fn fn) {
+            lock_guard<mutex> lock(writeMtx_);
+            const T* old = current_.load(memory_order_relaxed);
+            T* next = new T(*old);
+            fn(*next);
+            current_.store(next, memory_order_release);
+            EpochReclamation::EpochManager::getInstance().retire(const_cast<T*>(old));
+        }
+    };
+
+    struct DbConfig {
+        int poolSize;
+        int timeoutMs;
+        int replicaCount;
+        bool readOnly;
+    };
+
+    // Database singleton whose hot config is read lock-free.
+    class ConfiguredDatabase {
+        Seqlock<DbConfig> config_{DbConfig{8, 500, 2, false}};
+        SnapshotPtr<vector<string>> replicas_{vector<string>{"db-replica-1", "db-replica-2"}};
+        ConfiguredDatabase() = default;
+    public:
+        static ConfiguredDatabase& getInstance() {
+            static ConfiguredDatabase instance;
+            return instance;
+        }
+
+        DbConfig config() const { return config_.load(); }
+        void setTimeout(int ms) { config_.update([ms](DbConfig& c) { c.timeoutMs = ms; }); }
+
+        string pickReplica(size_t hash) const {
+            return replicas_.read([hash](const vector<string>& r) { return r[hash % r.size()]; });
+        }
+        // replicaCount is published from inside the replica-list update, so
+        // concurrent adds cannot interleave the two writes; readers may
+        // briefly see the new list with the old count, never a wrong count.
+        void addReplica(const string& name) {
+            replicas_.update([&](vector<string>& r) {
+                r.push_back(name);
+                int count = static_cast<int>(r.size());
+                config_.update([count](DbConfig& c) { c.replicaCount = count; });
+            });
+        }
+    };
+
+    // Mutex-guarded baseline with the same interface as Seqlock.
+    template <typename T>
+    class MutexGuarded {
+        mutable mutex mtx_;
+        T value_;
+    public:
+        explicit MutexGuarded(const T& v = T{}) : value_(v) {}
+        T load() const { lock_guard<mutex> lock(mtx_); return value_; }
+        void store(const T& v) { lock_guard<mutex> lock(mtx_); value_ = v; }
+    };
+
+    // Adapts SnapshotPtr to load()/store() for the benchmark.
+    template <typename T>
+    class SnapshotAdapter {
+        SnapshotPtr<T> ptr_;
+    public:
+        explicit SnapshotAdapter(const T& v = T{}) : ptr_(v) {}
+        T load() const { return ptr_.read([](const T& v) { return v; }); }
+        void store(const T& v) { ptr_.update([&](T& cur) { cur = v; }); }
+    };
+
+    // 99% load / 1% store mix over DbConfig.
+    template <typename Cell>
+    double readMostlyBenchmark(int threads, int ops) {
+        Cell cell(DbConfig{8, 500, 2, false});
+        vector<thread> workers;
+        atomic<long long> sink{0};
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                long long local = 0;
+                for (int i = 0; i < ops; ++i) {
+                    if ((i + t) % 100 == 0) cell.store(DbConfig{8, i, 2, false});
+                    else local += cell.load().timeoutMs;
+                }
+                sink += local;
+            });
+        }
+        for (auto& w : workers) w.join();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    void demo() {
+        auto& db = ConfiguredDatabase::getInstance();
+        thread writer([&] {
+            for (int ms = 600; ms <= 1000; ms += 100) db.setTimeout(ms);
+            db.addReplica("db-replica-3");
+        });
+        thread reader([&] {
+            for (int i = 0; i < 5; ++i) {
+                DbConfig c = db.config();
+                (void)c;
+            }
+        });
+        writer.join();
+        reader.join();
+
+        DbConfig c = db.config();
+        cout << "  Config: pool=" << c.poolSize << " timeout=" << c.timeoutMs
+             << "ms replicas=" << c.replicaCount << "\n";
+        cout << "  Replica for hash 2: " << db.pickReplica(2) << "\n";
+    }
+
+    void benchmark() {
+        const int ops = 200000;
+        cout << "  99% reads | threads |   mutex ms | seqlock ms | snapshot ms\n";
+        for (int threads : {1, 2, 4, 8}) {
+            double mutexMs = readMostlyBenchmark<MutexGuarded<DbConfig>>(threads, ops);
+            double seqMs = readMostlyBenchmark<Seqlock<DbConfig>>(threads, ops);
+            double snapMs = readMostlyBenchmark<SnapshotAdapter<DbConfig>>(threads, ops);
+            cout << fixed << setprecision(2) << "            | " << setw(7) << threads
+                 << " | " << setw(10) << mutexMs << " | " << setw(10) << seqMs
+                 << " | " << setw(11) << snapMs << "\n";
+        }
+    }
+}
+
+// ==========================================
+// 11. THREAD POOL + COROUTINE TASK RUNTIME (C++20)
+// ==========================================
+// Thread-per-task means one OS thread (and ~8MB of stack) for every
+// in-flight payment call. Coroutines turn "wait for I/O" into "suspend
+// and give the thread back", so thousands of logical tasks share a
+// handful of pool threads:
+//  - Task<T>:      lazily started coroutine; co_await it to get T.
+//  - sleepFor():   co_await-able timer (stands in for network latency).
+//  - Channel<T>:   bounded channel with co_await send()/receive().
+namespace AsyncRuntime {
+    class ThreadPool {
+        vector<thread> workers_;
+        queue<function<void()>> jobs_;
+        mutex mtx_;
+        condition_variable cv_;
+        bool stopping_ = false;
+
+        void workerLoop() {
+            while (true) {
+                function<void()> job;
+                {
+                    unique_lock<mutex> lock(mtx_);
+                    cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                    if (stopping_ && jobs_.empty()) return;
+                    job = move(jobs_.front());
+                    jobs_.pop();
+                }
+                job();
+            }
+        }
+
+    public:
+        explicit ThreadPool(size_t threads) {
+            for (size_t i = 0; i < threads; ++i) workers_.emplace_back([this] { workerLoop(); });
+        }
+
+        ~ThreadPool() {
+            {
+                lock_guard<mutex> lock(mtx_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            for (auto& w : workers_) w.join();   // drains remaining jobs first
+        }
+
+        void post(function<void()> job) {
+            {
+                lock_guard<mutex> lock(mtx_);
+                jobs_.push(move(job));
+            }
+            cv_.notify_one();
+        }
+
+        size_t size() const { return workers_.size(); }
+    };
+
+#ifdef HAS_COROUTINES
+    template <typename T>
+    class Task;
+
+    // Shared promise plumbing: lazy start, and on completion resume whoever
+    // co_awaited us (symmetric transfer — no stack growth across chains).
+    struct PromiseBase {
+        coroutine_handle<> continuation;
+        exception_ptr error;
+
+        suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            template <typename P>
+            coroutine_handle<> await_suspend(coroutine_handle<P> h) noexcept {
+                auto next = h.promise().continuation;
+                return next ? next : noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { error = current_exception(); }
+    };
+
+    template <typename T>
+    class Task {
+    public:
+        struct promise_type : PromiseBase {
+            optional<T> value;
+            Task get_return_object() { return Task(coroutine_handle<promise_type>::from_promise(*this)); }
+            void return_value(T v) { value = move(v); }
+        };
+
+        Task(Task&& other) noexcept : h_(exchange(other.h_, {})) {}
+        Task(const Task&) = delete;
+        ~Task() { if (h_) h_.destroy(); }
+
+        bool await_ready() const noexcept { return false; }
+        coroutine_handle<> await_suspend(coroutine_handle<> awaiting) {
+            h_.promise().continuation = awaiting;
+            return h_;   // start the child on this thread
+        }
+        T await_resume() {
+            if (h_.promise().error) rethrow_exception(h_.promise().error);
+            return move(*h_.promise().value);
+        }
+
+    private:
+        explicit Task(coroutine_handle<promise_type> h) : h_(h) {}
+        coroutine_handle<promise_type> h_;
+    };
+
+    template <>
+    class Task<void> {
+    public:
+        struct promise_type : PromiseBase {
+            Task get_return_object() { return Task(coroutine_handle<promise_type>::from_promise(*this)); }
+            void return_void() {}
+        };
+
+        Task(Task&& other) noexcept : h_(exchange(other.h_, {})) {}
+        Task(const Task&) = delete;
+        ~Task() { if (h_) h_.destroy(); }
+
+        bool await_ready() const noexcept { return false; }
+        coroutine_handle<> await_suspend(coroutine_handle<> awaiting) {
+            h_.promise().continuation = awaiting;
+            return h_;
+        }
+        void await_resume() {
+            if (h_.promise().error) rethrow_exception(h_.promise().error);
+        }
+
+    private:
+        explicit Task(coroutine_handle<promise_type> h) : h_(h) {}
+        coroutine_handle<promise_type> h_;
+    };
+
+    // Fire-and-forget coroutine used to root spawned tasks.
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() { return {}; }
+            suspend_never initial_suspend() noexcept { return {}; }
+            suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { terminate(); }
+        };
+    };
+
+    class Runtime {
+        using Clock = chrono::steady_clock;
+        using Timer = pair<Clock::time_point, coroutine_handle<>>;
+
+        ThreadPool pool_;
+
+        // Timer thread: a min-heap of deadlines; expired handles go to the pool.
+        mutex timerMtx_;
+        condition_variable timerCv_;
+        priority_queue<Timer, vector<Timer>, greater<Timer>> timers_;
+        bool stopping_ = false;
+        thread timerThread_;
+
+        mutex idleMtx_;
+        condition_variable idleCv_;
+        long long liveTasks_ = 0;
+
+        void timerLoop() {
+            unique_lock<mutex> lock(timerMtx_);
+            while (!stopping_) {
+                if (timers_.empty()) {
+                    timerCv_.wait(lock);
+                    continue;
+                }
+                auto deadline = timers_.top().first;
+                if (Clock::now() < deadline) {
+                    timerCv_.wait_until(lock, deadline);
+                    continue;
+                }
+                auto h = timers_.top().second;
+                timers_.pop();
+                resume(h);
+            }
+        }
+
+        void taskFinished() {
+            lock_guard<mutex> lock(idleMtx_);
+            if (--liveTasks_ == 0) idleCv_.notify_all();
+        }
+
+    public:
+        explicit Runtime(size_t threads)
+            : pool_(threads), timerThread_([this] { timerLoop(); }) {}
+
+        ~Runtime() {
+            waitIdle();
+            {
+                lock_guard<mutex> lock(timerMtx_);
+                stopping_ = true;
+            }
+            timerCv_.notify_all();
+            timerThread_.join();
+        }
+
+        void resume(coroutine_handle<> h) { pool_.post([h] { h.resume(); }); }
+
+        // co_await rt.schedule() continues the coroutine on a pool thread.
+        auto schedule() {
+            struct Awaiter {
+                Runtime& rt;
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(coroutine_handle<> h) { rt.resume(h); }
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{*this};
+        }
+
+        // co_await rt.sleepFor(d) frees the thread until the deadline.
+        auto sleepFor(Clock::duration d) {
+            struct Awaiter {
+                Runtime& rt;
+                Clock::time_point deadline;
+                bool await_ready() const noexcept { return deadline <= Clock::now(); }
+                void await_suspend(coroutine_handle<> h) {
+                    // Once the timer is queued, the coroutine (and this awaiter
+                    // inside its frame) may be resumed and gone on another
+                    // thread, so touch nothing but locals after the push.
+                    Runtime& runtime = rt;
+                    {
+                        lock_guard<mutex> lock(runtime.timerMtx_);
+                        runtime.timers_.push({deadline, h});
+                    }
+                    runtime.timerCv_.notify_one();
+                }
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{*this, Clock::now() + d};
+        }
+
+    private:
+        // Defined after schedule() so its deduced return type is known.
+        static Detached runRoot(Runtime& rt, Task<void> task) {
+            co_await rt.schedule();   // hop off the spawning thread
+            co_await task;
+            rt.taskFinished();
+        }
+
+    public:
+        void spawn(Task<void> task) {
+            {
+                lock_guard<mutex> lock(idleMtx_);
+                ++liveTasks_;
+            }
+            runRoot(*this, move(task));
+        }
+
+        void waitIdle() {
+            unique_lock<mutex> lock(idleMtx_);
+            idleCv_.wait(lock, [this] { return liveTasks_ == 0; });
+        }
+
+        size_t threads() const { return pool_.size(); }
+    };
+
+    // Bounded multi-producer/multi-consumer channel. Suspended senders and
+    // receivers are resumed on the pool, never inline under the lock.
+    // Capacity 0 is a rendezvous: each send waits for a receiver to take it.
+    // co_await send() yields false if the channel was closed before the value
+    // was accepted (including senders still parked when close() runs).
+    template <typename T>
+    class Channel {
+        struct PendingSend { coroutine_handle<> h; T* value; bool* accepted; };
+        struct PendingRecv { coroutine_handle<> h; optional<T>* slot; };
+
+        Runtime& rt_;
+        size_t capacity_;
+        mutex mtx_;
+        deque<T> buffer_;
+        deque<PendingSend> senders_;
+        deque<PendingRecv> receivers_;
+        bool closed_ = false;
+
+    public:
+        Channel(Runtime& rt, size_t capacity) : rt_(rt), capacity_(capacity) {}
+
+        auto send(T value) {
+            struct Awaiter {
+                Channel& ch;
+                T value;
+                bool accepted = true;
+                bool await_ready() const noexcept { return false; }
+                bool await_suspend(coroutine_handle<> h) {
+                    lock_guard<mutex> lock(ch.mtx_);
+                    if (ch.closed_) {
+                        accepted = false;
+                        return false;
+                    }
+                    if (!ch.receivers_.empty()) {           // hand straight to a waiter
+                        PendingRecv r = ch.receivers_.front();
+                        ch.receivers_.pop_front();
+                        *r.slot = move(value);
+                        ch.rt_.resume(r.h);
+                        return false;
+                    }
+                    if (ch.buffer_.size() < ch.capacity_) {
+                        ch.buffer_.push_back(move(value));
+                        return false;
+                    }
+                    ch.senders_.push_back({h, &value, &accepted});   // full: backpressure
+                    return true;
+                }
+                bool await_resume() const noexcept { return accepted; }
+            };
+            return Awaiter{*this, move(value)};
+        }
+
+        // Yields nullopt once the channel is closed and drained.
+        auto receive() {
+            struct Awaiter {
+                Channel& ch;
+                optional<T> result;
+                bool await_ready() const noexcept { return false; }
+                bool await_suspend(coroutine_handle<> h) {
+                    lock_guard<mutex> lock(ch.mtx_);
+                    if (!ch.buffer_.empty()) {
+                        result = move(ch.buffer_.front());
+                        ch.buffer_.pop_front();
+                        if (!ch.senders_.empty()) {         // admit one blocked sender
+                            PendingSend s = ch.senders_.front();
+                            ch.senders_.pop_front();
+                            ch.buffer_.push_back(move(*s.value));
+                            ch.rt_.resume(s.h);
+                        }
+                        return false;
+                    }
+                    if (!ch.senders_.empty()) {             // rendezvous (capacity 0)
+                        PendingSend s = ch.senders_.front();
+                        ch.senders_.pop_front();
+                        result = move(*s.value);
+                        ch.rt_.resume(s.h);
+                        return false;
+                    }
+                    if (ch.closed_) return false;
+                    ch.receivers_.push_back({h, &result});
+                    return true;
+                }
+                optional<T> await_resume() { return move(result); }
+            };
+            return Awaiter{*this, nullopt};
+        }
+
+        void close() {
+            lock_guard<mutex> lock(mtx_);
+            closed_ = true;
+            for (auto& r : receivers_) rt_.resume(r.h);   // wake with nullopt
+            receivers_.clear();
+            for (auto& snd : senders_) {                  // value never accepted
+                *snd.accepted = false;
+                rt_.resume(snd.h);
+            }
+            senders_.clear();
+        }
+    };
+
+    // --- BookMyShow: awaited payment gateway calls ---
+    Task<bool> chargeCard(Runtime& rt, int amount) {
+        co_await rt.sleepFor(chrono::milliseconds(20));   // simulated gateway RTT
+        co_return amount > 0;
+    }
+
+    Task<void> bookTicket(Runtime& rt, int amount, atomic<int>& confirmed) {
+        bool paid = co_await chargeCard(rt, amount);
+        if (paid) confirmed++;
+    }
+
+    // --- NotificationSystem: channel fan-in to delivery workers ---
+    Task<void> publishEvents(Channel<string>& ch, string channelName, int count,
+                             atomic<int>& publishersLeft) {
+        for (int i = 0; i < count; ++i) co_await ch.send(channelName + "#" + to_string(i));
+        if (--publishersLeft == 0) ch.close();
+    }
+
+    Task<void> deliverNotifications(Runtime& rt, Channel<string>& ch, atomic<int>& delivered) {
+        while (auto msg = co_await ch.receive()) {
+            co_await rt.sleepFor(chrono::microseconds(100));   // simulated provider call
+            delivered++;
+        }
+    }
+
+    void demo() {
+        Runtime rt(4);
+
+        const int bookings = 10000;
+        atomic<int> confirmed{0};
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < bookings; ++i) rt.spawn(bookTicket(rt, 15, confirmed));
+        rt.waitIdle();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "  " << confirmed << "/" << bookings << " payments (20ms each) on "
+             << rt.threads() << " threads in " << fixed << setprecision(1) << ms
+             << " ms (sequential: " << bookings * 20 / 1000 << " s)\n";
+
+        Channel<string> notifications(rt, 64);
+        atomic<int> publishersLeft{3}, delivered{0};
+        for (const char* name : {"Email", "SMS", "Push"})
+            rt.spawn(publishEvents(notifications, name, 1000, publishersLeft));
+        for (int i = 0; i < 50; ++i) rt.spawn(deliverNotifications(rt, notifications, delivered));
+        rt.waitIdle();
+        cout << "  Notifications delivered through channel: " << delivered << "/3000\n";
+    }
+#else
+    void demo() {
+        ThreadPool pool(4);
+        atomic<int> done{0};
+        for (int i = 0; i < 100; ++i) pool.post([&] { done++; });
+        cout << "  (coroutine runtime needs -std=c++20; thread pool only)\n";
+    }
+#endif
+}
+
+// ==========================================
+// 12. QUEUE TRACING + LATENCY HISTOGRAMS
+// ==========================================
+// "The consumer is slow" could mean it waits for the lock, waits for
+// items, or spends its time processing. QueueTracer records timed spans
+// into per-thread buffers (no shared writes on the hot path), then merges
+// them into HDR-style latency histograms and a Chrome trace
+// (open the JSON in chrome://tracing or ui.perfetto.dev).
+// TracedQueue<T> is a drop-in bounded blocking queue with the probes
+// built in; any other queue can call span()/record() directly.
+namespace QueueTracing {
+    using Clock = chrono::steady_clock;
+
+    // Log-linear buckets: each power of two is split into 16 linear
+    // sub-buckets, so every recorded value is within ~6% of its bucket.
+    class LatencyHistogram {
+        static constexpr int SUB_BITS = 4;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+        static constexpr int MAJOR = 64 - SUB_BITS + 1;
+
+        vector<uint64_t> counts_ = vector<uint64_t>(MAJOR * SUB_BUCKETS, 0);
+        uint64_t total_ = 0;
+        uint64_t max_ = 0;
+
+        static int indexOf(uint64_t v) {
+            if (v < SUB_BUCKETS) return static_cast<int>(v);
+            int msb = 63 - __builtin_clzll(v);
+            int major = msb - SUB_BITS + 1;
+            int sub = static_cast<int>((v >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+            return major * SUB_BUCKETS + sub;
+        }
+
+        static uint64_t upperBoundOf(int index) {
+            int major = index / SUB_BUCKETS, sub = index % SUB_BUCKETS;
+            if (major == 0) return sub;
+            int shift = major + SUB_BITS - 1 - SUB_BITS;
+            return ((uint64_t(SUB_BUCKETS + sub) + 1) << shift) - 1;
+        }
+
+    public:
+        void record(uint64_t ns) {
+            counts_[indexOf(ns)]++;
+            total_++;
+            max_ = max(max_, ns);
+        }
+
+        void merge(const LatencyHistogram& other) {
+            for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+            total_ += other.total_;
+            max_ = max(max_, other.max_);
+        }
+
+        uint64_t percentile(double pct) const {
+            if (total_ == 0) return 0;
+            uint64_t target = static_cast<uint64_t>(total_ * pct / 100.0), seen = 0;
+            for (size_t i = 0; i < counts_.size(); ++i) {
+                seen += counts_[i];
+                if (seen > target) return min(upperBoundOf(static_cast<int>(i)), max_);
+            }
+            return max_;
+        }
+
+        uint64_t count() const { return total_; }
+        uint64_t maxValue() const { return max_; }
+    };
+
+    class QueueTracer {
+    public:
+        struct Span {
+            const char* name;
+            uint64_t item;
+            int64_t startNs;    // relative to tracer start
+            int64_t durNs;
+        };
+
+    private:
+        struct ThreadBuffer {
+            int tid;
+            string threadName;
+            vector<Span> spans;
+        };
+
+        static inline atomic<uint64_t> nextTracerId_{1};
+
+        const uint64_t tracerId_ = nextTracerId_.fetch_add(1, memory_order_relaxed);
+        Clock::time_point origin_ = Clock::now();
+        mutex registryMtx_;                          // taken on cache misses only
+        vector<unique_ptr<ThreadBuffer>> buffers_;
+        unordered_map<thread::id, ThreadBuffer*> byThread_;
+
+        ThreadBuffer& local() {
+            // One-entry cache: a thread normally reports to a single tracer.
+            // Keyed on a never-reused id, not the address: a new tracer built
+            // where a destroyed one lived must not hit the freed buffer.
+            thread_local uint64_t cachedTracerId = 0;
+            thread_local ThreadBuffer* cachedBuffer = nullptr;
+            if (cachedTracerId != tracerId_) {
+                lock_guard<mutex> lock(registryMtx_);
+                ThreadBuffer*& buf = byThread_[this_thread::get_id()];
+                if (!buf) {   // first span from this thread: register it
+                    buffers_.push_back(make_unique<ThreadBuffer>());
+                    buffers_.back()->tid = static_cast<int>(buffers_.size());
+                    buffers_.back()->spans.reserve(4096);
+                    buf = buffers_.back().get();
+                }
+                cachedTracerId = tracerId_;
+                cachedBuffer = buf;
+            }
+            return *cachedBuffer;
+        }
+
+        static void writeJsonString(ostream& out, const string& text) {
+            out << '"';
+            for (char c : text) {
+                if (c == '"' || c == '\\') out << '\\';
+                out << c;
+            }
+            out << '"';
+        }
+
+    public:
+        int64_t now() const {
+            return chrono::duration_cast<chrono::nanoseconds>(Clock::now() - origin_).count();
+        }
+
+        void nameThread(const string& name) { local().threadName = name; }
+
+        void record(const char* name, uint64_t item, int64_t startNs, int64_t endNs) {
+            local().spans.push_back({name, item, startNs, endNs - startNs});
+        }
+
+        // RAII span: times its own scope.
+        class ScopedSpan {
+            QueueTracer& tracer_;
+            const char* name_;
+            uint64_t item_;
+            int64_t start_;
+        public:
+            ScopedSpan(QueueTracer& t, const char* name, uint64_t item)
+                : tracer_(t), name_(name), item_(item), start_(t.now()) {}
+            ~ScopedSpan() { tracer_.record(name_, item_, start_, tracer_.now()); }
+        };
+
+        ScopedSpan span(const char* name, uint64_t item = 0) { return ScopedSpan(*this, name, item); }
+
+        // Call after the traced threads have joined.
+        map<string, LatencyHistogram> histograms() {
+            lock_guard<mutex> lock(registryMtx_);
+            map<string, LatencyHistogram> result;
+            for (auto& buf : buffers_)
+                for (const Span& s : buf->spans) result[s.name].record(static_cast<uint64_t>(s.durNs));
+            return result;
+        }
+
+        void printHistograms() {
+            cout << "  span             |  count |   p50 us |   p99 us | p99.9 us |   max us\n";
+            for (auto& [name, h] : histograms()) {
+                cout << "  " << left << setw(16) << name << right << " | " << setw(6) << h.count()
+                     << fixed << setprecision(1)
+                     << " | " << setw(8) << h.percentile(50) / 1e3
+                     << " | " << setw(8) << h.percentile(99) / 1e3
+                     << " | " << setw(8) << h.percentile(99.9) / 1e3
+                     << " | " << setw(8) << h.maxValue() / 1e3 << "\n";
+            }
+        }
+
+        // Chrome trace event format: one complete ("X") event per span.
+        void writeChromeTrace(ostream& out) {
+            lock_guard<mutex> lock(registryMtx_);
+            out << "{\"traceEvents\":[\n";
+            bool first = true;
+            auto sep = [&] { if (!first) out << ",\n"; first = false; };
+            for (auto& buf : buffers_) {
+                if (!buf->threadName.empty()) {
+                    sep();
+                    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buf->tid
+                        << ",\"args\":{\"name\":";
+                    writeJsonString(out, buf->threadName);
+                    out << "}}";
+                }
+                for (const Span& s : buf->spans) {
+                    sep();
+                    out << "{\"name\":\"" << s.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid
+                        << fixed << setprecision(3)
+                        << ",\"ts\":" << s.startNs / 1e3 << ",\"dur\":" << s.durNs / 1e3
+                        << ",\"args\":{\"item\":" << s.item << "}}";
+                }
+            }
+            out << "\n]}\n";
+        }
+    };
+
+    // Bounded blocking queue (same shape as ProducerConsumer's buffer)
+    // with lock-wait, blocked-wait and time-in-queue probes.
+    template <typename T>
+    class TracedQueue {
+        struct Entry {
+            T value;
+            uint64_t item;
+            int64_t enqueuedNs;
+        };
+
+        QueueTracer& tracer_;
+        size_t capacity_;
+        queue<Entry> buffer_;
+        mutex mtx_;
+        condition_variable notFull_, notEmpty_;
+        bool closed_ = false;
+        atomic<uint64_t> nextItem_{1};
+
+    public:
+        TracedQueue(QueueTracer& tracer, size_t capacity) : tracer_(tracer), capacity_(capacity) {}
+
+        void push(T value) {
+            uint64_t item = nextItem_.fetch_add(1, memory_order_relaxed);
+            int64_t t0 = tracer_.now();
+            unique_lock<mutex> lock(mtx_);
+            int64_t t1 = tracer_.now();
+            tracer_.record("push.lock_wait", item, t0, t1);
+
+            notFull_.wait(lock, [this] { return buffer_.size() < capacity_; });
+            int64_t t2 = tracer_.now();
+            if (t2 - t1 > 1000) tracer_.record("push.full_wait", item, t1, t2);
+
+            buffer_.push({move(value), item, t2});
+            lock.unlock();
+            notEmpty_.notify_one();
+        }
+
+        // Returns false once the queue is closed and drained. `item` receives
+        // the trace id so callers can tag their processing span.
+        bool pop(T& out, uint64_t& item) {
+            int64_t t0 = tracer_.now();
+            unique_lock<mutex> lock(mtx_);
+            int64_t t1 = tracer_.now();
+
+            notEmpty_.wait(lock, [this] { return !buffer_.empty() || closed_; });
+            int64_t t2 = tracer_.now();
+            if (buffer_.empty()) return false;
+
+            Entry e = move(buffer_.front());
+            buffer_.pop();
+            lock.unlock();
+            notFull_.notify_one();
+
+            tracer_.record("pop.lock_wait", e.item, t0, t1);
+            if (t2 - t1 > 1000) tracer_.record("pop.empty_wait", e.item, t1, t2);
+            tracer_.record("queued", e.item, e.enqueuedNs, t2);
+            out = move(e.value);
+            item = e.item;
+            return true;
+        }
+
+        void close() {
+            {
+                lock_guard<mutex> lock(mtx_);
+                closed_ = true;
+            }
+            notEmpty_.notify_all();
+        }
+    };
+
+    // ProducerConsumer's workload, traced: 1 producer, 2 consumers, buffer 5,
+    // consumers slower than the producer.
+    void demo() {
+        QueueTracer tracer;
+        TracedQueue<int> buffer(tracer, 5);
+
+        thread producer([&] {
+            tracer.nameThread("Producer");
+            for (int i = 1; i <= 200; ++i) {
+                buffer.push(i);
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+            buffer.close();
+        });
+
+        auto consumer = [&](const string& name) {
+            tracer.nameThread(name);
+            int value;
+            uint64_t item;
+            while (buffer.pop(value, item)) {
+                auto span = tracer.span("process", item);
+                this_thread::sleep_for(chrono::microseconds(500));
+            }
+        };
+        thread cons1(consumer, "Consumer-1");
+        thread cons2(consumer, "Consumer-2");
+
+        producer.join();
+        cons1.join();
+        cons2.join();
+
+        tracer.printHistograms();
+        ofstream trace("producer_consumer.trace.json");
+        tracer.writeChromeTrace(trace);
+        cout << "  Chrome trace written to producer_consumer.trace.json\n";
+    }
+}
+
 int main() {
     cout << "=== 1. Race Condition (Unsafe) ===" << endl;
     RaceCondition::demo();
@@ -202,5 +1953,30 @@ int main() {
     cout << "\n=== 5. Deadlock Prevention ===" << endl;
     DeadlockPrevention::demo();
 
+    cout << "\n=== 6. Sharded Counter ===" << endl;
+    ShardedCounting::demo();
+    ShardedCounting::benchmark();
+
+    cout << "\n=== 7. Adaptive Mutex + Contention Stats ===" << endl;
+    AdaptiveLocking::demo();
+    AdaptiveLocking::benchmark();
+
+    cout << "\n=== 8. Lock Hierarchy Checker ===" << endl;
+    LockOrdering::demo();
+
+    cout << "\n=== 9. Epoch-Based Reclamation ===" << endl;
+    EpochReclamation::demo();
+    EpochReclamation::benchmark();
+
+    cout << "\n=== 10. Seqlock + Snapshot Reads ===" << endl;
+    SnapshotReads::demo();
+    SnapshotReads::benchmark();
+
+    cout << "\n=== 11. Coroutine Task Runtime ===" << endl;
+    AsyncRuntime::demo();
+
+    cout << "\n=== 12. Queue Tracing + Latency Histograms ===" << endl;
+    QueueTracing::demo();
+
     return 0;
 }